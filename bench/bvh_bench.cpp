@@ -0,0 +1,119 @@
+// BVH microbenchmark: build, refit and query throughput against a linear
+// scan over the same boxes.
+//
+//   bvh_bench [primitive count] [query count]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+#include "bvh.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? size_t(std::atoll(argv[1])) : 100000;
+    size_t queries = argc > 2 ? size_t(std::atoll(argv[2])) : 100000;
+
+    // Props scattered over a 500 m level, clustered the way real placements are.
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> cluster(-250.0f, 250.0f), offset(-10.0f, 10.0f), size(0.2f, 2.0f);
+    std::vector<Aabb> boxes(count);
+    for (size_t i = 0; i < count; i += 64) {
+        glm::vec3 c{cluster(rng), cluster(rng) * 0.05f, cluster(rng)};
+        for (size_t j = i; j < std::min(count, i + 64); ++j) {
+            glm::vec3 p = c + glm::vec3(offset(rng), offset(rng) * 0.2f, offset(rng));
+            glm::vec3 h(size(rng) * 0.5f);
+            boxes[j] = {p - h, p + h};
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << count << " primitives, " << queries << " queries\n";
+
+    Bvh bvh;
+    auto start = Clock::now();
+    bvh.build(boxes);
+    std::cout << "build          " << std::setw(10) << msSince(start) << " ms  (" << bvh.nodes.size() << " nodes)\n";
+
+    std::uniform_real_distribution<float> jitter(-0.05f, 0.05f);
+    for (Aabb& b : boxes) {
+        glm::vec3 d{jitter(rng), jitter(rng), jitter(rng)};
+        b.min += d;
+        b.max += d;
+    }
+    start = Clock::now();
+    bvh.refit(boxes);
+    std::cout << "refit          " << std::setw(10) << msSince(start) << " ms\n";
+
+    // Rays from random points in the level towards random directions.
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<glm::vec3> origins(queries), dirs(queries);
+    for (size_t i = 0; i < queries; ++i) {
+        origins[i] = {cluster(rng), unit(rng) * 5.0f, cluster(rng)};
+        dirs[i] = glm::normalize(glm::vec3(unit(rng), unit(rng) * 0.2f, unit(rng)) + glm::vec3(0.0f, 0.0f, 1e-3f));
+    }
+    size_t hits = 0;
+    start = Clock::now();
+    for (size_t i = 0; i < queries; ++i) {
+        BvhHit hit;
+        hits += bvh.raycast(origins[i], dirs[i], 100.0f, hit);
+    }
+    double rayMs = msSince(start);
+    std::cout << "raycast        " << std::setw(10) << queries / rayMs / 1000.0 << " Mrays/s  (" << hits << " hits)\n";
+
+    std::vector<uint32_t> found;
+    size_t overlapHits = 0;
+    start = Clock::now();
+    for (size_t i = 0; i < queries; ++i) {
+        Aabb q{origins[i] - glm::vec3(1.0f), origins[i] + glm::vec3(1.0f)};
+        found.clear();
+        bvh.queryOverlap(q, found);
+        overlapHits += found.size();
+    }
+    double overlapMs = msSince(start);
+    std::cout << "overlap        " << std::setw(10) << queries / overlapMs / 1000.0 << " Mqueries/s  (" << overlapHits << " results)\n";
+
+    glm::mat4 proj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 300.0f);
+    Frustum frustum = extractFrustum(proj * glm::lookAt(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(1.0f, 2.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+    const int frustumRuns = 100;
+    start = Clock::now();
+    for (int i = 0; i < frustumRuns; ++i) {
+        found.clear();
+        bvh.queryFrustum(frustum, found);
+    }
+    std::cout << "frustum        " << std::setw(10) << msSince(start) / frustumRuns << " ms/query  (" << found.size() << " visible)\n";
+
+    // Linear references on a subset so the benchmark stays quick; also checks
+    // that the BVH returns the same answers.
+    size_t linearQueries = std::min<size_t>(queries, 1000);
+    size_t mismatches = 0;
+    start = Clock::now();
+    for (size_t i = 0; i < linearQueries; ++i) {
+        Aabb q{origins[i] - glm::vec3(1.0f), origins[i] + glm::vec3(1.0f)};
+        size_t n = 0;
+        for (const Aabb& b : boxes) n += overlaps(q, b);
+        found.clear();
+        bvh.queryOverlap(q, found);
+        mismatches += n != found.size();
+
+        // Nearest hit must agree with a brute force slab test.
+        float bestT = 100.0f;
+        glm::vec3 invDir = 1.0f / dirs[i];
+        for (const Aabb& b : boxes) bestT = std::min(bestT, intersectRay(origins[i], invDir, bestT, b.min, b.max));
+        BvhHit hit;
+        bool hitBvh = bvh.raycast(origins[i], dirs[i], 100.0f, hit);
+        mismatches += hitBvh != (bestT < 100.0f) || (hitBvh && std::abs(hit.t - bestT) > 1e-4f);
+    }
+    std::cout << "overlap linear " << std::setw(10) << linearQueries / msSince(start) / 1000.0 << " Mqueries/s  ("
+              << mismatches << " mismatches)\n";
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,101 @@
+// ECS microbenchmark: entity creation, structural changes and per-tick
+// system iteration (serial and on the job system) over tens of thousands of
+// entities, with a plain array-of-structs loop as the reference.
+//
+//   ecs_bench [entity count] [ticks] [threads]
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "ecs.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Pos { float x, y, z; };
+struct Vel { float x, y, z; };
+struct Health { float value; };
+struct Tag { uint32_t bits; };
+
+// Everything an object-oriented entity would carry, touched or not.
+struct FatEntity {
+    Pos pos;
+    Vel vel;
+    Health health;
+    Tag tag;
+    float unrelated[24];
+};
+
+static void integrate(Pos& p, Vel& v, float dt) {
+    v.y -= 9.8f * dt;
+    p.x += v.x * dt;
+    p.y += v.y * dt;
+    p.z += v.z * dt;
+    if (p.y < 0.0f) {
+        p.y = -p.y;
+        v.y = -v.y * 0.8f;
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? size_t(std::atoll(argv[1])) : 50000;
+    int ticks = argc > 2 ? std::atoi(argv[2]) : 200;
+    unsigned threads = argc > 3 ? unsigned(std::atoi(argv[3])) : 0;
+    const float dt = 1.0f / 120.0f;
+
+    JobSystem jobs;
+    jobs.init(threads);
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> r(-10.0f, 10.0f);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << count << " entities, " << ticks << " ticks, " << jobs.threadCount() << " threads\n";
+
+    World world;
+    auto start = Clock::now();
+    std::vector<Entity> entities;
+    entities.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        Pos p{r(rng), std::abs(r(rng)), r(rng)};
+        Vel v{r(rng), 0.0f, r(rng)};
+        // A quarter also have Health, so iteration spans two archetypes.
+        if (i % 4 == 0) entities.push_back(world.create(p, v, Health{100.0f}));
+        else entities.push_back(world.create(p, v));
+    }
+    std::cout << "create           " << std::setw(10) << msSince(start) << " ms\n";
+
+    start = Clock::now();
+    for (size_t i = 0; i < count; i += 2) world.add(entities[i], Tag{uint32_t(i)});
+    for (size_t i = 0; i < count; i += 2) world.remove<Tag>(entities[i]);
+    std::cout << "add+remove half  " << std::setw(10) << msSince(start) << " ms\n";
+
+    start = Clock::now();
+    for (int t = 0; t < ticks; ++t) world.each<Pos, Vel>([dt](Entity, Pos& p, Vel& v) { integrate(p, v, dt); });
+    double serialMs = msSince(start) / ticks;
+    std::cout << "each/tick        " << std::setw(10) << serialMs << " ms\n";
+
+    start = Clock::now();
+    for (int t = 0; t < ticks; ++t)
+        world.parallelEach<Pos, Vel>(jobs, 4096, [dt](Entity, Pos& p, Vel& v) { integrate(p, v, dt); });
+    double parallelMs = msSince(start) / ticks;
+    std::cout << "parallelEach/tick" << std::setw(10) << parallelMs << " ms  (" << serialMs / parallelMs
+              << "x)\n";
+
+    std::vector<FatEntity> fat(count);
+    for (FatEntity& f : fat) f = FatEntity{{r(rng), std::abs(r(rng)), r(rng)}, {r(rng), 0.0f, r(rng)}, {100.0f}, {0}, {}};
+    start = Clock::now();
+    for (int t = 0; t < ticks; ++t)
+        for (FatEntity& f : fat) integrate(f.pos, f.vel, dt);
+    std::cout << "AoS loop/tick    " << std::setw(10) << msSince(start) / ticks << " ms\n";
+
+    start = Clock::now();
+    for (size_t i = 0; i < count; ++i) world.destroy(entities[i]);
+    std::cout << "destroy          " << std::setw(10) << msSince(start) << " ms\n";
+    return world.entityCount() == 0 ? 0 : 1;
+}
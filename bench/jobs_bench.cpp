@@ -0,0 +1,125 @@
+// Job system scaling benchmark: runs a synthetic frame (animation, culling
+// and command building as a task graph of parallel loops) with 1 to N
+// threads and reports frame time and speedup over one thread.
+//
+//   jobs_bench [entity count] [frames] [max threads]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include "job_system.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Entities {
+    std::vector<float> x, y, z, phase;
+    std::vector<float> matrices;        // 16 floats per entity
+    std::vector<unsigned char> visible;
+    std::vector<uint32_t> commands;
+};
+
+// Enough arithmetic per entity that the loop is compute bound, like skinning
+// or animation sampling rather than a memcpy.
+static void animate(Entities& e, size_t begin, size_t end, float time) {
+    for (size_t i = begin; i < end; ++i) {
+        float a = time + e.phase[i];
+        for (int k = 0; k < 8; ++k) a = std::sin(a) * 1.5f + std::cos(a * 0.5f);
+        float* m = &e.matrices[i * 16];
+        float c = std::cos(a), s = std::sin(a);
+        m[0] = c;  m[1] = 0; m[2] = -s; m[3] = 0;
+        m[4] = 0;  m[5] = 1; m[6] = 0;  m[7] = 0;
+        m[8] = s;  m[9] = 0; m[10] = c; m[11] = 0;
+        m[12] = e.x[i]; m[13] = e.y[i] + 0.1f * s; m[14] = e.z[i]; m[15] = 1;
+    }
+}
+
+static void cull(Entities& e, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        float d = e.x[i] * 0.7071f + e.z[i] * 0.7071f;
+        float r = std::sqrt(e.x[i] * e.x[i] + e.z[i] * e.z[i]);
+        e.visible[i] = d > -5.0f && r < 400.0f;
+    }
+}
+
+static void buildCommands(Entities& e, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+        e.commands[i] = e.visible[i] ? uint32_t(e.matrices[i * 16 + 12] * 16.0f) ^ uint32_t(i) : 0u;
+}
+
+static void runFrame(JobSystem& jobs, Entities& e, float time) {
+    const size_t n = e.x.size();
+    const size_t grain = 1024;
+    TaskGraph graph;
+    size_t animateTask = graph.add([&] {
+        jobs.parallelFor(n, grain, [&](size_t b, size_t end) { animate(e, b, end, time); });
+    });
+    size_t cullTask = graph.add([&] {
+        jobs.parallelFor(n, grain, [&](size_t b, size_t end) { cull(e, b, end); });
+    });
+    size_t commandTask = graph.add([&] {
+        jobs.parallelFor(n, grain, [&](size_t b, size_t end) { buildCommands(e, b, end); });
+    });
+    graph.precede(animateTask, commandTask);
+    graph.precede(cullTask, commandTask);
+    jobs.run(graph);
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? size_t(std::atoll(argv[1])) : 200000;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 100;
+    unsigned maxThreads = argc > 3 ? unsigned(std::atoi(argv[3])) : std::thread::hardware_concurrency();
+    if (maxThreads == 0) maxThreads = 1;
+
+    Entities e;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> pos(-500.0f, 500.0f), phase(0.0f, 6.2831853f);
+    for (size_t i = 0; i < count; ++i) {
+        e.x.push_back(pos(rng));
+        e.y.push_back(0.0f);
+        e.z.push_back(pos(rng));
+        e.phase.push_back(phase(rng));
+    }
+    e.matrices.resize(count * 16);
+    e.visible.resize(count);
+    e.commands.resize(count);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << count << " entities, " << frames << " frames\n";
+    std::cout << "threads  ms/frame  speedup  stolen/frame\n";
+    double baseline = 0.0;
+    uint64_t reference = 0;
+    for (unsigned threads = 1; threads <= maxThreads; ++threads) {
+        JobSystem jobs;
+        jobs.init(threads);
+        runFrame(jobs, e, 0.0f);   // warm up caches and wake the workers
+        uint64_t stolenBefore = jobs.stolenJobs.load();
+        auto start = Clock::now();
+        for (int f = 0; f < frames; ++f) runFrame(jobs, e, float(f) * 0.016f);
+        double ms = msSince(start) / frames;
+        double stolen = double(jobs.stolenJobs.load() - stolenBefore) / frames;
+        jobs.shutdown();
+
+        // Every thread count must produce the same commands.
+        uint64_t checksum = 0;
+        for (uint32_t c : e.commands) checksum = checksum * 31 + c;
+        if (threads == 1) {
+            baseline = ms;
+            reference = checksum;
+        } else if (checksum != reference) {
+            std::cerr << "Result mismatch with " << threads << " threads" << std::endl;
+            return 1;
+        }
+        std::cout << std::setw(7) << threads << std::setw(10) << ms << std::setw(9) << baseline / ms
+                  << std::setw(14) << stolen << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,157 @@
+// Model loader benchmark: writes a terrain grid of roughly the requested
+// size as OBJ and as GLB to the temp directory, then times parsing each
+// (plus any model files given) from a memory mapping. Generated files are
+// checked for the expected vertex and triangle counts and deleted afterwards.
+//
+//   model_bench [megabytes] [model files...]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "model_loader.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static float height(size_t x, size_t z) {
+    return std::sin(float(x) * 0.05f) * std::cos(float(z) * 0.07f) * 4.0f;
+}
+
+// About 150 bytes of text per grid vertex.
+static bool writeObj(const std::string& path, size_t side) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    for (size_t z = 0; z < side; ++z)
+        for (size_t x = 0; x < side; ++x) std::fprintf(f, "v %.6f %.6f %.6f\n", float(x), height(x, z), float(z));
+    for (size_t z = 0; z < side; ++z)
+        for (size_t x = 0; x < side; ++x)
+            std::fprintf(f, "vt %.6f %.6f\n", float(x) / float(side - 1), float(z) / float(side - 1));
+    for (size_t i = 0; i < side * side; ++i) std::fprintf(f, "vn 0.000000 1.000000 0.000000\n");
+    for (size_t z = 0; z + 1 < side; ++z) {
+        for (size_t x = 0; x + 1 < side; ++x) {
+            size_t a = z * side + x + 1, b = a + 1, c = a + side, d = c + 1;
+            std::fprintf(f, "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n", a, a, a, c, c, c, d, d, d, b, b, b);
+        }
+    }
+    return std::fclose(f) == 0;
+}
+
+// 32 bytes per vertex plus 24 bytes of indices per quad.
+static bool writeGlb(const std::string& path, size_t side) {
+    const size_t vertexCount = side * side, indexCount = (side - 1) * (side - 1) * 6;
+    std::vector<float> positions, normals, uvs;
+    positions.reserve(vertexCount * 3);
+    normals.reserve(vertexCount * 3);
+    uvs.reserve(vertexCount * 2);
+    for (size_t z = 0; z < side; ++z) {
+        for (size_t x = 0; x < side; ++x) {
+            positions.insert(positions.end(), {float(x), height(x, z), float(z)});
+            normals.insert(normals.end(), {0.0f, 1.0f, 0.0f});
+            uvs.insert(uvs.end(), {float(x) / float(side - 1), float(z) / float(side - 1)});
+        }
+    }
+    std::vector<uint32_t> indices;
+    indices.reserve(indexCount);
+    for (size_t z = 0; z + 1 < side; ++z) {
+        for (size_t x = 0; x + 1 < side; ++x) {
+            uint32_t a = uint32_t(z * side + x), b = a + 1, c = a + uint32_t(side), d = c + 1;
+            indices.insert(indices.end(), {a, c, d, d, b, a});
+        }
+    }
+    const size_t sizes[4] = {positions.size() * 4, normals.size() * 4, uvs.size() * 4, indices.size() * 4};
+    const size_t offsets[4] = {0, sizes[0], sizes[0] + sizes[1], sizes[0] + sizes[1] + sizes[2]};
+    const size_t binSize = offsets[3] + sizes[3];
+    std::string json =
+        "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+        "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},\"indices\":3}]}],"
+        "\"buffers\":[{\"byteLength\":" + std::to_string(binSize) + "}],\"bufferViews\":[";
+    for (int i = 0; i < 4; ++i) {
+        json += std::string(i ? "," : "") + "{\"buffer\":0,\"byteOffset\":" + std::to_string(offsets[i]) +
+                ",\"byteLength\":" + std::to_string(sizes[i]) + "}";
+    }
+    json += "],\"accessors\":["
+            "{\"bufferView\":0,\"componentType\":5126,\"count\":" + std::to_string(vertexCount) + ",\"type\":\"VEC3\"},"
+            "{\"bufferView\":1,\"componentType\":5126,\"count\":" + std::to_string(vertexCount) + ",\"type\":\"VEC3\"},"
+            "{\"bufferView\":2,\"componentType\":5126,\"count\":" + std::to_string(vertexCount) + ",\"type\":\"VEC2\"},"
+            "{\"bufferView\":3,\"componentType\":5125,\"count\":" + std::to_string(indexCount) + ",\"type\":\"SCALAR\"}]}";
+    json.resize((json.size() + 3) & ~size_t(3), ' ');
+
+    std::ofstream out(path, std::ios::binary);
+    auto u32 = [&](size_t v) {
+        uint32_t x = uint32_t(v);
+        out.write(reinterpret_cast<const char*>(&x), 4);
+    };
+    u32(0x46546C67);
+    u32(2);
+    u32(12 + 8 + json.size() + 8 + binSize);
+    u32(json.size());
+    u32(0x4E4F534A);
+    out.write(json.data(), std::streamsize(json.size()));
+    u32(binSize);
+    u32(0x004E4942);
+    out.write(reinterpret_cast<const char*>(positions.data()), std::streamsize(sizes[0]));
+    out.write(reinterpret_cast<const char*>(normals.data()), std::streamsize(sizes[1]));
+    out.write(reinterpret_cast<const char*>(uvs.data()), std::streamsize(sizes[2]));
+    out.write(reinterpret_cast<const char*>(indices.data()), std::streamsize(sizes[3]));
+    return bool(out);
+}
+
+// Best of three loads; the first also faults the file into the page cache.
+static bool benchLoad(const std::string& path, size_t expectVertices, size_t expectTriangles) {
+    ModelData model;
+    double best = 1e30;
+    for (int run = 0; run < 3; ++run) {
+        auto start = Clock::now();
+        if (!loadModel(path, model)) return false;
+        best = std::min(best, msSince(start));
+    }
+    double megabytes = double(std::filesystem::file_size(path)) / (1024.0 * 1024.0);
+    size_t triangles = model.indices.size() / 3;
+    std::cout << std::filesystem::path(path).filename().string() << "  " << std::setw(8) << megabytes << " MB  "
+              << std::setw(10) << best << " ms  " << std::setw(8) << megabytes * 1000.0 / best << " MB/s  "
+              << std::setw(8) << double(triangles) / best / 1000.0 << " Mtri/s  (" << model.vertices.size()
+              << " vertices, " << triangles << " triangles)\n";
+    if (expectTriangles && (model.vertices.size() != expectVertices || triangles != expectTriangles)) {
+        std::cout << "UNEXPECTED COUNTS, wanted " << expectVertices << " vertices and " << expectTriangles
+                  << " triangles" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    double megabytes = argc > 1 ? std::atof(argv[1]) : 300.0;
+    std::cout << std::fixed << std::setprecision(1);
+
+    bool ok = true;
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const struct {
+        const char* name;
+        double bytesPerVertex;
+        bool (*write)(const std::string&, size_t);
+    } formats[] = {{"model_bench.obj", 150.0, writeObj}, {"model_bench.glb", 56.0, writeGlb}};
+    for (const auto& format : formats) {
+        size_t side = std::max<size_t>(2, size_t(std::sqrt(megabytes * 1024.0 * 1024.0 / format.bytesPerVertex)));
+        std::string path = (dir / format.name).string();
+        auto start = Clock::now();
+        if (!format.write(path, side)) {
+            std::cerr << "Failed to write " << path << std::endl;
+            return 1;
+        }
+        std::cout << "wrote " << path << " in " << msSince(start) << " ms\n";
+        ok = benchLoad(path, side * side, (side - 1) * (side - 1) * 2) && ok;
+        std::filesystem::remove(path);
+    }
+    for (int i = 2; i < argc; ++i) ok = benchLoad(argv[i], 0, 0) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// LZ4 block format (byte-oriented LZ77: literal runs and back references of
+// at least 4 bytes within 64 KiB, no entropy coding), so decoding runs at
+// memory speed. Compatible with the reference LZ4_decompress_safe() block
+// format; there is no frame header, so callers store the sizes.
+
+// Replaces out with the compressed form of src. Greedy single-probe match
+// finder: fast, and within a few percent of the reference fast mode.
+void blockCompress(const unsigned char* src, size_t size, std::vector<unsigned char>& out);
+// Decodes exactly dstSize bytes; false if the input is malformed or does not
+// decode to dstSize bytes. Never reads or writes out of bounds.
+bool blockDecompress(const unsigned char* src, size_t srcSize, unsigned char* dst, size_t dstSize);
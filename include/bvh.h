@@ -0,0 +1,79 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "frustum.h"
+
+struct Aabb {
+    glm::vec3 min{0.0f};
+    glm::vec3 max{0.0f};
+};
+
+inline bool overlaps(const Aabb& a, const Aabb& b) {
+    return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+           a.min.y <= b.max.y && a.max.y >= b.min.y &&
+           a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+// Slab test against a box; returns the entry distance (0 when the origin is
+// inside) or FLT_MAX when the ray misses or enters beyond maxT.
+inline float intersectRay(const glm::vec3& origin, const glm::vec3& invDir, float maxT,
+                          const glm::vec3& bmin, const glm::vec3& bmax) {
+    float tx1 = (bmin.x - origin.x) * invDir.x, tx2 = (bmax.x - origin.x) * invDir.x;
+    float tmin = std::min(tx1, tx2), tmax = std::max(tx1, tx2);
+    float ty1 = (bmin.y - origin.y) * invDir.y, ty2 = (bmax.y - origin.y) * invDir.y;
+    tmin = std::max(tmin, std::min(ty1, ty2));
+    tmax = std::min(tmax, std::max(ty1, ty2));
+    float tz1 = (bmin.z - origin.z) * invDir.z, tz2 = (bmax.z - origin.z) * invDir.z;
+    tmin = std::max(tmin, std::min(tz1, tz2));
+    tmax = std::min(tmax, std::max(tz1, tz2));
+    if (tmax >= std::max(tmin, 0.0f) && tmin < maxT) return std::max(tmin, 0.0f);
+    return FLT_MAX;
+}
+
+// 32 bytes, two nodes per cache line. Siblings are stored next to each other
+// and always after their parent, which is what lets refit() run as a single
+// backwards sweep.
+struct BvhNode {
+    glm::vec3 boundsMin;
+    uint32_t leftFirst;   // left child index, or first entry in Bvh::indices for a leaf
+    glm::vec3 boundsMax;
+    uint32_t count;       // primitives in a leaf, 0 for an interior node
+};
+
+struct BvhHit {
+    uint32_t index = 0;   // primitive index as passed to build()
+    float t = 0.0f;       // distance along the ray direction
+};
+
+// Bounding volume hierarchy over axis-aligned boxes. Built top-down with a
+// binned surface area heuristic and flattened into one node array.
+struct Bvh {
+    static constexpr uint32_t maxLeafSize = 4;
+    static constexpr int binCount = 16;
+    static constexpr int maxDepth = 48;   // keeps query stacks at a fixed size
+
+    std::vector<BvhNode> nodes;
+    std::vector<uint32_t> indices;   // primitive indices referenced by the leaves
+    std::vector<Aabb> boxes;         // primitive bounds, by primitive index
+
+    bool empty() const { return nodes.empty(); }
+    void build(const std::vector<Aabb>& primitives);
+    // Recomputes node bounds for moved primitives without changing the tree.
+    // Cheap, but quality degrades if objects travel far; rebuild then.
+    void refit(const std::vector<Aabb>& primitives);
+
+    // Appends primitives whose box intersects the frustum.
+    void queryFrustum(const Frustum& frustum, std::vector<uint32_t>& out) const;
+    // Appends primitives whose box overlaps box.
+    void queryOverlap(const Aabb& box, std::vector<uint32_t>& out) const;
+    // Nearest primitive box hit within maxT, dir need not be normalized.
+    bool raycast(const glm::vec3& origin, const glm::vec3& dir, float maxT, BvhHit& hit) const;
+
+private:
+    void updateBounds(uint32_t node);
+    void subdivide(uint32_t node, const std::vector<glm::vec3>& centroids, int depth);
+};
@@ -0,0 +1,19 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+
+struct Camera {
+    glm::vec3 position{0.0f, 1.0f, 0.0f};
+    float pitch = 0.0f;
+    float yaw = -90.0f;
+
+    glm::mat4 getViewMatrix() const {
+        glm::vec3 front{
+            cos(glm::radians(yaw)) * cos(glm::radians(pitch)),
+            sin(glm::radians(pitch)),
+            sin(glm::radians(yaw)) * cos(glm::radians(pitch))
+        };
+        return glm::lookAt(position, position + glm::normalize(front), {0.0f, 1.0f, 0.0f});
+    }
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include "player.h"
+
+// Game components stored in the ECS World. Camera and CharacterController
+// are used as components directly.
+
+struct Position {
+    glm::vec3 value{0.0f};
+};
+
+// Position at the previous tick; rendering interpolates towards Position.
+struct PreviousPosition {
+    glm::vec3 value{0.0f};
+};
+
+struct Velocity {
+    glm::vec3 value{0.0f};
+};
+
+struct Grounded {
+    bool value = false;
+};
+
+// Input sampled once per frame, consumed by every tick in that frame.
+struct PlayerControl {
+    PlayerInput input;
+};
+
+// Index of a dynamic body in the PhysicsWorld.
+struct PhysicsBody {
+    size_t body = 0;
+};
+
+// Index of an object in the render Scene.
+struct SceneObject {
+    size_t index = 0;
+};
@@ -0,0 +1,228 @@
+#pragma once
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "job_system.h"
+
+// Entity-component-system with archetype storage. Every distinct set of
+// component types is an archetype holding one tightly packed array per
+// component (structure of arrays), so a system touching two components
+// streams through exactly two arrays. Adding or removing a component moves
+// the entity to another archetype; prefer creating entities with their full
+// component set in one call.
+//
+// Components must be trivially copyable: rows are moved with memcpy.
+
+constexpr size_t maxComponentTypes = 64;
+using ComponentMask = std::bitset<maxComponentTypes>;
+
+struct Entity {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool operator==(const Entity& o) const { return index == o.index && generation == o.generation; }
+    bool operator!=(const Entity& o) const { return !(*this == o); }
+};
+
+// Assigns ids in first-use order; the size is recorded so archetypes can be
+// built from a mask alone.
+uint32_t registerComponentType(size_t size);
+size_t componentTypeSize(uint32_t id);
+
+template <class T>
+uint32_t componentId() {
+    static_assert(std::is_trivially_copyable<T>::value, "components must be trivially copyable");
+    static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned components are not supported");
+    static const uint32_t id = registerComponentType(sizeof(T));
+    return id;
+}
+
+template <class... Ts>
+ComponentMask componentMask() {
+    ComponentMask mask;
+    (mask.set(componentId<Ts>()), ...);
+    return mask;
+}
+
+struct Archetype {
+    ComponentMask mask;
+    std::vector<uint32_t> componentIds;
+    std::vector<size_t> componentSizes;                // parallel to componentIds
+    std::vector<std::vector<unsigned char>> columns;   // parallel to componentIds
+    std::vector<Entity> entities;                      // row -> entity
+    int8_t columnOf[maxComponentTypes];                // component id -> column, -1 if absent
+
+    size_t size() const { return entities.size(); }
+
+    template <class T>
+    T* column() {
+        int c = columnOf[componentId<T>()];
+        return c < 0 ? nullptr : reinterpret_cast<T*>(columns[size_t(c)].data());
+    }
+};
+
+struct World {
+    World();
+
+    Entity create();
+    // Creates the entity directly in its final archetype.
+    template <class... Ts>
+    Entity create(const Ts&... components);
+    void destroy(Entity e);
+    bool alive(Entity e) const;
+    size_t entityCount() const { return records.size() - freeIndices.size(); }
+
+    template <class T>
+    void add(Entity e, const T& component);
+    template <class T>
+    void remove(Entity e);
+    template <class T>
+    bool has(Entity e) const;
+    // Valid until the next structural change (create, destroy, add, remove).
+    template <class T>
+    T* get(Entity e);
+
+    // Calls fn(Entity, Ts&...) for every entity with all of Ts, archetype by
+    // archetype in storage order.
+    template <class... Ts, class Fn>
+    void each(Fn&& fn);
+    // Same, split into chunks of grain rows on the job system. fn must only
+    // touch the row it is given; structural changes are not allowed.
+    template <class... Ts, class Fn>
+    void parallelEach(JobSystem& jobs, size_t grain, Fn&& fn);
+    template <class... Ts>
+    size_t count() const;
+
+    const std::vector<std::unique_ptr<Archetype>>& allArchetypes() const { return archetypes; }
+
+private:
+    struct Record {
+        uint32_t archetype = 0;
+        uint32_t row = 0;
+        uint32_t generation = 0;
+        bool alive = false;
+    };
+
+    uint32_t archetypeFor(const ComponentMask& mask);
+    Entity allocateEntity();
+    uint32_t appendRow(Archetype& a, Entity e);
+    void removeRow(Archetype& a, uint32_t row);
+    void moveEntity(Entity e, uint32_t to);
+    unsigned char* componentPtr(Archetype& a, uint32_t row, uint32_t id);
+
+    template <class... Ts, class Fn>
+    static void eachRow(Archetype& a, size_t begin, size_t end, Fn& fn);
+
+    std::vector<std::unique_ptr<Archetype>> archetypes;   // index 0 is the empty archetype
+    std::unordered_map<ComponentMask, uint32_t> archetypeIndex;
+    std::vector<Record> records;
+    std::vector<uint32_t> freeIndices;
+};
+
+template <class... Ts>
+Entity World::create(const Ts&... components) {
+    Entity e = allocateEntity();
+    uint32_t a = archetypeFor(componentMask<Ts...>());
+    Archetype& arch = *archetypes[a];
+    uint32_t row = appendRow(arch, e);
+    (std::memcpy(componentPtr(arch, row, componentId<Ts>()), &components, sizeof(Ts)), ...);
+    records[e.index].archetype = a;
+    records[e.index].row = row;
+    return e;
+}
+
+template <class T>
+void World::add(Entity e, const T& component) {
+    if (!alive(e)) return;
+    uint32_t id = componentId<T>();
+    const Record& r = records[e.index];
+    ComponentMask mask = archetypes[r.archetype]->mask;
+    if (!mask.test(id)) moveEntity(e, archetypeFor(mask.set(id)));
+    const Record& moved = records[e.index];
+    std::memcpy(componentPtr(*archetypes[moved.archetype], moved.row, id), &component, sizeof(T));
+}
+
+template <class T>
+void World::remove(Entity e) {
+    if (!alive(e)) return;
+    uint32_t id = componentId<T>();
+    ComponentMask mask = archetypes[records[e.index].archetype]->mask;
+    if (mask.test(id)) moveEntity(e, archetypeFor(mask.reset(id)));
+}
+
+template <class T>
+bool World::has(Entity e) const {
+    return alive(e) && archetypes[records[e.index].archetype]->mask.test(componentId<T>());
+}
+
+template <class T>
+T* World::get(Entity e) {
+    if (!alive(e)) return nullptr;
+    const Record& r = records[e.index];
+    T* column = archetypes[r.archetype]->template column<T>();
+    return column ? column + r.row : nullptr;
+}
+
+template <class... Ts, class Fn>
+void World::eachRow(Archetype& a, size_t begin, size_t end, Fn& fn) {
+    // Column pointers are fetched once per archetype, not per entity.
+    std::tuple<Ts*...> columns{a.template column<Ts>()...};
+    const Entity* entities = a.entities.data();
+    for (size_t i = begin; i < end; ++i) fn(entities[i], std::get<Ts*>(columns)[i]...);
+}
+
+template <class... Ts, class Fn>
+void World::each(Fn&& fn) {
+    ComponentMask required = componentMask<Ts...>();
+    for (auto& a : archetypes) {
+        if (a->size() && (a->mask & required) == required) eachRow<Ts...>(*a, 0, a->size(), fn);
+    }
+}
+
+template <class... Ts, class Fn>
+void World::parallelEach(JobSystem& jobs, size_t grain, Fn&& fn) {
+    ComponentMask required = componentMask<Ts...>();
+    for (auto& a : archetypes) {
+        if (!a->size() || (a->mask & required) != required) continue;
+        Archetype& arch = *a;
+        jobs.parallelFor(arch.size(), grain, [&](size_t begin, size_t end) { eachRow<Ts...>(arch, begin, end, fn); });
+    }
+}
+
+template <class... Ts>
+size_t World::count() const {
+    ComponentMask required = componentMask<Ts...>();
+    size_t n = 0;
+    for (const auto& a : archetypes)
+        if ((a->mask & required) == required) n += a->size();
+    return n;
+}
+
+// Runs registered systems as a task graph. Each system declares the
+// components it reads and writes; two systems are ordered (in registration
+// order) only when one writes something the other touches, otherwise they
+// run in parallel. Exclusive systems, for work on state outside the world
+// such as stepping the physics engine, are ordered against every system.
+struct SystemScheduler {
+    using Fn = std::function<void(World&, float)>;
+
+    void add(const char* name, ComponentMask reads, ComponentMask writes, Fn fn);
+    void addExclusive(const char* name, Fn fn);
+    void run(World& world, JobSystem& jobs, float dt);
+
+private:
+    struct System {
+        const char* name;   // string literal, also the profiler zone name
+        ComponentMask reads, writes;
+        bool exclusive;
+        Fn fn;
+    };
+    std::vector<System> systems;
+};
@@ -0,0 +1,16 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include "camera.h"
+
+// Closed Catmull-Rom spline through the room used by benchmark mode. The
+// camera pose depends only on the normalized path parameter, so every run
+// with the same frame count sees exactly the same sequence of views.
+struct Flythrough {
+    std::vector<glm::vec3> points;
+
+    static Flythrough defaultPath();
+
+    glm::vec3 position(float t) const;   // t in [0, 1], wraps around
+    void apply(Camera& cam, float t) const;
+};
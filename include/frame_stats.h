@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Distribution summary of one timing series, in milliseconds.
+struct TimingSummary {
+    size_t count = 0;
+    double avg = 0.0, min = 0.0, p50 = 0.0, p95 = 0.0, p99 = 0.0, max = 0.0;
+};
+
+TimingSummary summarize(const std::vector<double>& values);
+
+// Per-frame timings in milliseconds. frameMs is the full loop iteration
+// (including swap), cpuMs the time spent before the swap. GPU times arrive a
+// frame or more late (timer queries are read back without stalling), so they
+// are stored by frame index rather than appended.
+struct FrameStats {
+    std::vector<double> frameMs;
+    std::vector<double> cpuMs;
+    std::vector<double> gpuMs;   // negative until the query result is known
+
+    // Named per-frame series, indexed by frame like gpuMs: GPU time per
+    // render pass, and engine counters such as culling results.
+    struct Series {
+        std::string name;
+        std::vector<double> values;
+    };
+    std::vector<Series> gpuPasses;   // milliseconds
+    std::vector<Series> counters;    // unit is part of the name
+
+    static constexpr double histogramBucketMs = 0.25;
+    static constexpr size_t histogramBuckets = 200;   // last bucket collects overflow
+
+    size_t frameCount() const { return frameMs.size(); }
+    void recordFrame(double frame, double cpu);
+    void recordGpu(size_t frame, double ms);
+    void recordGpuPass(size_t frame, const std::string& pass, double ms);
+    // Adds to the named counter of a frame that has already been recorded.
+    void recordCounter(size_t frame, const std::string& name, double value);
+
+    std::vector<size_t> histogram() const;
+
+    void printSummary(std::ostream& out) const;
+    bool writeCsv(const std::string& path) const;
+    bool writeJson(const std::string& path, const std::string& label) const;
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include <glm/glm.hpp>
+
+// Six planes (xyz normal, w distance) pointing into the view volume.
+struct Frustum {
+    glm::vec4 planes[6];
+};
+
+// Gribb/Hartmann extraction from a projection * view matrix.
+inline Frustum extractFrustum(const glm::mat4& m) {
+    // Rows of the matrix; glm is column-major so row i is m[*][i].
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; ++i) row[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+
+    Frustum f;
+    f.planes[0] = row[3] + row[0];   // left
+    f.planes[1] = row[3] - row[0];   // right
+    f.planes[2] = row[3] + row[1];   // bottom
+    f.planes[3] = row[3] - row[1];   // top
+    f.planes[4] = row[3] + row[2];   // near
+    f.planes[5] = row[3] - row[2];   // far
+    for (glm::vec4& p : f.planes) {
+        float len = glm::length(glm::vec3(p.x, p.y, p.z));
+        p = p * (1.0f / len);
+    }
+    return f;
+}
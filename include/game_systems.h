@@ -0,0 +1,18 @@
+#pragma once
+#include "camera.h"
+#include "ecs.h"
+#include "job_system.h"
+#include "physics.h"
+#include "scene.h"
+
+// Player entity: Camera, Position, PreviousPosition, Velocity, Grounded,
+// PlayerControl and a CharacterController capsule at the camera position.
+Entity createPlayer(World& world, PhysicsWorld& physics, const Camera& camera);
+
+// Systems run once per fixed tick: character movement from input, the
+// physics step, then reading character state back into components.
+void addTickSystems(SystemScheduler& scheduler, PhysicsWorld& physics);
+
+// Copies every PhysicsBody transform to its SceneObject, in parallel.
+// The caller refits the scene BVH afterwards.
+void syncRigidBodies(World& world, JobSystem& jobs, const PhysicsWorld& physics, Scene& scene);
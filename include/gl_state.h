@@ -0,0 +1,63 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+// Shadow of the GL bindings the renderer changes, so binding what is already
+// bound costs a compare instead of a driver call. It only stays correct if
+// every bind of a tracked kind goes through here; call reset() after code
+// that binds GL objects directly. There is one GL context, hence one global
+// instance from glState().
+//
+// Element array buffer bindings are VAO state, so changing the VAO forgets
+// the element buffer.
+struct GlState {
+    static constexpr int textureUnits = 16;
+    static constexpr int textureTargets = 4;   // 2D, 2D array, 3D, cube map
+    static constexpr int bufferTargets = 8;
+    static constexpr int uniformBindings = 16;
+
+    // Marks everything unknown; the next call of each kind is issued.
+    void reset();
+
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vao);
+    void bindBuffer(GLenum target, GLuint buffer);
+    // Indexed uniform buffer binding; other targets pass straight through.
+    void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+    // Selects the unit with glActiveTexture only when a bind is needed.
+    void bindTexture(GLuint unit, GLenum target, GLuint texture);
+    void setEnabled(GLenum capability, bool enabled);
+
+    // Call after deleting an object so a recycled name is not mistaken for
+    // the old binding.
+    void forgetProgram(GLuint program);
+    void forgetVertexArray(GLuint vao);
+    void forgetBuffer(GLuint buffer);
+    void forgetTexture(GLuint texture);
+
+    uint64_t issued = 0;    // driver calls made
+    uint64_t skipped = 0;   // calls avoided because the state already matched
+
+private:
+    static constexpr GLuint unknown = ~0u;
+
+    bool track(GLuint& current, GLuint value);
+
+    GLuint program = unknown;
+    GLuint vao = unknown;
+    GLuint activeUnit = unknown;
+    GLuint buffers[bufferTargets];
+    GLuint textures[textureUnits][textureTargets];
+    struct Range {
+        GLuint buffer;
+        GLintptr offset;
+        GLsizeiptr size;
+    };
+    Range uniformRanges[uniformBindings];
+    std::unordered_map<GLenum, bool> capabilities;
+    bool initialized = false;
+};
+
+GlState& glState();
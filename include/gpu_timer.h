@@ -0,0 +1,66 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct GpuPassTime {
+    const char* name;
+    uint64_t startNs;   // GL timestamp, see GpuTimer::cpuOffsetNs
+    double ms;
+};
+
+struct GpuFrameTimes {
+    size_t frame;
+    double totalMs;
+    std::vector<GpuPassTime> passes;
+};
+
+// Attributes GPU time to named passes with GL_TIMESTAMP queries. Timestamps
+// are used rather than GL_TIME_ELAPSED because elapsed queries cannot nest or
+// overlap. Queries live in a ring of ringSize frames and are only read once
+// GL_QUERY_RESULT_AVAILABLE reports them done, so reading never stalls; a
+// frame whose slot is still busy when the ring wraps is dropped instead.
+struct GpuTimer {
+    static constexpr int ringSize = 4;
+    static constexpr int maxQueriesPerFrame = 32;
+
+    void init();
+    void shutdown();
+
+    void beginFrame(size_t frame);
+    void beginPass(const char* name);   // passes may nest
+    void endPass();
+    void endFrame();
+
+    // Results for every frame that has finished on the GPU since the last
+    // call. wait blocks for outstanding frames, meant for shutdown only.
+    std::vector<GpuFrameTimes> collect(bool wait = false);
+
+    // Add to a GL timestamp to get profilerNowNs() time, for trace export.
+    int64_t cpuOffsetNs = 0;
+    size_t droppedFrames = 0;
+
+private:
+    struct Pass {
+        const char* name;
+        int beginQuery;
+        int endQuery;
+    };
+    struct Slot {
+        GLuint queries[maxQueriesPerFrame] = {};
+        int used = 0;
+        size_t frame = 0;
+        bool pending = false;
+        std::vector<Pass> passes;
+    };
+
+    int issue(Slot& slot);
+    bool available(const Slot& slot) const;
+    GpuFrameTimes resolve(Slot& slot);
+
+    Slot slots[ringSize];
+    Slot* current = nullptr;
+    std::vector<int> openPasses;
+    bool initialized = false;
+};
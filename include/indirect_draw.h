@@ -0,0 +1,44 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+#include "mesh_pool.h"
+
+// Command layout read by glMultiDrawElementsIndirect.
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// Records draws of pooled meshes into a GL_DRAW_INDIRECT_BUFFER and submits
+// them all with one glMultiDrawElementsIndirect call (GL 4.3 or
+// ARB_multi_draw_indirect), so CPU cost barely grows with the number of
+// draws. Older drivers replay the commands one at a time, with
+// glDrawElementsInstancedBaseVertexBaseInstance when base instances are
+// supported and by moving the instance attributes otherwise.
+struct IndirectDraws {
+    enum class Mode { MultiDraw, BaseInstance, Replay };
+
+    void init();
+    void destroy();
+
+    void clear() { commands.clear(); }
+    // Draws instanceCount instances of mesh reading the pool's instance
+    // buffer from firstInstance.
+    void add(const MeshRange& mesh, GLuint firstInstance, GLuint instanceCount);
+    // The caller binds the program; the pool's VAO is bound here.
+    void submit(MeshPool& pool);
+
+    size_t size() const { return commands.size(); }
+    Mode mode() const { return submitMode; }
+    const char* modeName() const;
+
+private:
+    std::vector<DrawElementsIndirectCommand> commands;
+    GLuint buffer = 0;
+    size_t capacity = 0;
+    Mode submitMode = Mode::Replay;
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+#include "indirect_draw.h"
+#include "mesh_pool.h"
+#include "shader.h"
+
+struct UniformRing;
+
+// Unit cube centred on the origin, 24 vertices so every face has its own UVs.
+bool createCubeMesh(MeshPool& pool, MeshRange& mesh);
+
+// Renders every instance through one of two programs: the instanced one, or
+// a per-object reference path (one uniform block binding and draw per
+// instance) kept to measure what instancing saves. Both come from a
+// ShaderBatch and draw untextured until their real program has finished
+// compiling (and not at all before the untextured one has). The "Frame"
+// block must already be bound and, for the instanced path, the instances
+// uploaded to the pool.
+struct InstanceRenderer {
+    ShaderBatch* shaders = nullptr;
+    size_t instancedShader = 0;
+    size_t perObjectShader = 0;
+    std::vector<GLintptr> objectOffsets;   // per-object path scratch
+};
+
+// Adds the renderer's programs, built for meshes in format, to shaders;
+// call before shaders.submit().
+bool createInstanceRenderer(InstanceRenderer& renderer, ShaderBatch& shaders, VertexFormat format);
+void destroyInstanceRenderer(InstanceRenderer& renderer);
+void drawInstances(InstanceRenderer& renderer, MeshPool& pool, const MeshRange& mesh,
+                   const std::vector<InstanceData>& instances, UniformRing& uniforms, bool perObject);
+// Submits recorded indirect draws with the instanced program.
+void drawIndirect(InstanceRenderer& renderer, MeshPool& pool, IndirectDraws& draws);
+
+// Deterministic stress scene: count boxes of varying size and texture layer
+// scattered through the room volume.
+std::vector<InstanceData> makeCrateScene(size_t count, size_t layerCount);
@@ -0,0 +1,105 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts unfinished jobs; wait on it with JobSystem::wait().
+struct JobCounter {
+    std::atomic<size_t> pending{0};
+    bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+// Jobs with dependencies, built up front and executed by JobSystem::run().
+// A node starts once every node that precedes it has finished.
+struct TaskGraph {
+    size_t add(std::function<void()> fn);
+    void precede(size_t before, size_t after);
+    size_t size() const { return nodes.size(); }
+    void clear() { nodes.clear(); }
+
+private:
+    friend struct JobSystem;
+    struct Node {
+        std::function<void()> fn;
+        std::vector<size_t> successors;
+        size_t predecessors = 0;
+        std::atomic<size_t> remaining{0};
+    };
+    std::deque<Node> nodes;   // deque: nodes hold atomics and must not move
+};
+
+// Work-stealing scheduler. Every thread owns a deque; it pushes and pops its
+// own jobs at the back (most recent first, while their data is still in
+// cache) and idle threads steal from the front of the others. The thread
+// that calls init() is thread 0 and takes part in the work whenever it
+// waits, so frame work submitted from the main thread never stalls on an
+// idle pool.
+//
+// Background jobs (asset decode and other long work) sit in a separate
+// queue that only the pool's own threads take, so a frame waiting on its
+// culling jobs never picks up a 20 ms decode. With a single thread there
+// are no pool threads: wait() runs them too, and owners of background work
+// drain it a few jobs at a time with runBackground().
+struct JobSystem {
+    ~JobSystem() { shutdown(); }
+
+    // threadCount includes the calling thread; 0 uses every hardware thread.
+    void init(unsigned threadCount = 0);
+    void shutdown();
+    unsigned threadCount() const { return unsigned(queues.size()); }
+
+    void submit(std::function<void()> fn, JobCounter* counter = nullptr);
+    void submitBackground(std::function<void()> fn, JobCounter* counter = nullptr);
+    // Executes other jobs until counter reaches zero.
+    void wait(JobCounter& counter);
+    // Without pool threads, runs up to maxJobs background jobs on the
+    // calling thread; otherwise does nothing. Returns how many ran.
+    size_t runBackground(size_t maxJobs);
+
+    // Calls body(begin, end) over [0, count) in chunks of grain items,
+    // running the first chunk on the calling thread. Returns when all
+    // chunks have finished.
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+    // Runs every node of graph and waits for them. Returns false, running
+    // nothing, if the dependencies contain a cycle.
+    bool run(TaskGraph& graph);
+
+    std::atomic<uint64_t> executedJobs{0};
+    std::atomic<uint64_t> stolenJobs{0};
+
+private:
+    struct Job {
+        std::function<void()> fn;
+        JobCounter* counter = nullptr;
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    int localIndex() const;
+    void push(Queue& queue, Job job);
+    bool popLocal(int index, Job& job);
+    bool steal(int thief, Job& job);
+    bool popBackground(Job& job);
+    bool findJob(int index, bool background, Job& job);
+    void execute(Job& job);
+    void workerLoop(unsigned index);
+    void runNode(TaskGraph& graph, size_t node, JobCounter& counter);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    Queue background;
+    std::vector<std::thread> threads;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<size_t> queued{0};
+    std::atomic<bool> stopping{false};
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include "level_format.h"
+#include "mapped_file.h"
+
+// Read-only view of one section of a mapped level.
+template <typename T>
+struct LevelSpan {
+    const T* data = nullptr;
+    size_t count = 0;
+
+    const T* begin() const { return data; }
+    const T* end() const { return data + count; }
+    const T& operator[](size_t i) const { return data[i]; }
+    size_t size() const { return count; }
+};
+
+// Memory-mapped level file. open() validates the layout once and points the
+// spans at their sections; nothing is parsed or copied, so load time is the
+// cost of faulting in the pages that are actually read.
+struct Level {
+    bool open(const std::string& path);
+    // Uses a level already in memory, e.g. a pak entry. data must outlive
+    // the level and be 8-byte aligned; name is only used in error messages.
+    bool open(const unsigned char* data, size_t size, const std::string& name);
+
+    LevelSpan<LevelMaterial> materials;
+    LevelSpan<LevelMesh> meshes;
+    LevelSpan<Vertex> vertices;
+    LevelSpan<uint32_t> indices;
+    LevelSpan<LevelEntity> entities;
+    LevelSpan<LevelCollider> colliders;
+
+private:
+    MappedFile file;
+};
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include "mesh_pool.h"
+
+// On-disk layout of level files (*.lvl), written by the levelconv tool and
+// mapped directly by Level. The header lists one section per array, each at
+// an aligned offset from the start of the file; loading only turns those
+// offsets into pointers. Geometry is stored as engine Vertex values and
+// 32-bit indices relative to each mesh's first vertex, already run through
+// optimizeMesh(), so MeshPool::add() can read them from the mapping. Each
+// vertex's layer is its material index plus one, the row of the pool's
+// material table that the game fills from the level's materials.
+// Little-endian, no padding between fields.
+constexpr uint32_t levelMagic = 0x4C564C46;   // "FLVL"
+constexpr uint32_t levelVersion = 2;
+constexpr uint32_t levelNameLength = 32;
+constexpr uint32_t levelTextureNameLength = 48;   // cookedTextureNameLength
+constexpr uint32_t levelDataAlignment = 64;
+constexpr uint32_t levelMaxMaterials = uint32_t(maxPoolMaterials) - 1;   // row 0 is no material
+
+inline float levelVertexLayer(uint32_t material) { return float(material + 1); }
+
+struct LevelSection {
+    uint64_t offset;   // from the start of the file
+    uint64_t count;    // elements, not bytes
+};
+
+struct LevelHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t reserved;
+    LevelSection materials;   // LevelMaterial
+    LevelSection meshes;      // LevelMesh
+    LevelSection vertices;    // Vertex
+    LevelSection indices;     // uint32_t
+    LevelSection entities;    // LevelEntity
+    LevelSection colliders;   // LevelCollider
+};
+
+// Tint is baked into the vertices; the texture is resolved by name against
+// the loaded texture array when the level is opened.
+struct LevelMaterial {
+    char texture[levelTextureNameLength];   // NUL terminated
+};
+
+struct LevelMesh {
+    char name[levelNameLength];   // NUL terminated
+    uint32_t firstVertex;
+    uint32_t vertexCount;
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t material;   // of its first face; vertices carry their own
+    uint32_t reserved[3];
+};
+
+enum LevelEntityKind : uint32_t {
+    LevelPlayerStart = 1,   // position and yaw of the camera
+    LevelStaticMesh = 2,    // mesh drawn at position, yaw and uniform scale
+};
+
+struct LevelEntity {
+    uint32_t kind;
+    uint32_t mesh;        // LevelStaticMesh only
+    float position[3];
+    float yaw;            // degrees about +Y, Camera::yaw for the player start
+    float scale;
+    uint32_t reserved;
+};
+
+// Static collision boxes, axis aligned.
+struct LevelCollider {
+    float center[3];
+    float halfExtents[3];
+};
+
+static_assert(sizeof(Vertex) == 48, "level vertex layout");
+static_assert(sizeof(LevelHeader) == 112, "level header layout");
+static_assert(sizeof(LevelMaterial) == 48, "level material layout");
+static_assert(sizeof(LevelMesh) == 64, "level mesh layout");
+static_assert(sizeof(LevelEntity) == 32, "level entity layout");
+static_assert(sizeof(LevelCollider) == 24, "level collider layout");
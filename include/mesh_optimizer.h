@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include "mesh_pool.h"
+
+// Mesh processing run on every mesh before it reaches a MeshPool (and by
+// offline tools): merge duplicate vertices, order triangles for the
+// post-transform vertex cache, then for overdraw, then order vertices by
+// first use so fetches walk memory forwards. Indices are 32-bit throughout;
+// the pool narrows them to 16 bits when it can.
+
+// FIFO post-transform cache simulation.
+//   acmr  transformed vertices per triangle, 0.5 is ideal for a regular
+//         grid and 3 is the worst case
+//   atvr  transformed vertices per referenced vertex, 1 is ideal
+struct VertexCacheStats {
+    float acmr = 0.0f;
+    float atvr = 0.0f;
+};
+VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, unsigned cacheSize = 16);
+
+// Each step keeps the triangle set intact and only changes the order or
+// numbering. deduplicateVertices() and optimizeVertexFetch() also shrink
+// vertices to the vertices still referenced.
+void deduplicateVertices(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+// Tom Forsyth's linear-speed vertex cache optimisation.
+void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+// Sander, Nehab and Barczak's method: split the cache-optimised order into
+// clusters whose ACMR stays within threshold of the input's, then draw
+// outward-facing clusters first so they occlude the rest. Run after
+// optimizeVertexCache().
+void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, float threshold = 1.05f);
+void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+struct MeshOptimizeReport {
+    size_t verticesBefore = 0;
+    size_t verticesAfter = 0;
+    size_t triangles = 0;
+    VertexCacheStats before;
+    VertexCacheStats after;
+    bool shortIndices = false;   // every index fits in 16 bits
+};
+
+// All of the above in order.
+MeshOptimizeReport optimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+void printMeshReport(std::ostream& out, const char* name, const MeshOptimizeReport& report);
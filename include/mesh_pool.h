@@ -0,0 +1,120 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Source vertex handed to MeshPool::add(), which encodes it into the pool's
+// format. layer is a row of the pool's material table; that row's texture
+// layer is added to the instance's layer, so one static mesh can pick a
+// texture per face. Row 0 is always layer 0.
+struct Vertex {
+    glm::vec3 position;
+    glm::vec3 color;
+    glm::vec2 uv;
+    float layer;
+    glm::vec3 normal;
+};
+
+// How a pool stores its vertices on the GPU:
+//   Float         48 bytes, the Vertex struct as is.
+//   Compact       20 bytes: snorm16 position relative to the mesh bounds,
+//                 octahedral snorm16 normal, half-float UV, 16-bit layer.
+//                 The colour is one tint per mesh, taken from its first
+//                 vertex.
+//   CompactColor  24 bytes, Compact plus an RGBA8 colour per vertex.
+// Vertex shaders get the matching decoder from vertexShaderSource().
+enum class VertexFormat { Float, Compact, CompactColor };
+
+size_t vertexStride(VertexFormat format);
+const char* vertexFormatName(VertexFormat format);
+bool parseVertexFormat(const std::string& name, VertexFormat& format);
+
+// Compact pools keep per-mesh bounds and tint in a table read through this
+// uniform block binding.
+constexpr GLuint meshUniformBinding = 2;
+constexpr size_t maxPoolMeshes = 256;
+// Every pool keeps its material table (row to texture array layer) behind
+// this binding.
+constexpr GLuint materialUniformBinding = 3;
+constexpr size_t maxPoolMaterials = 64;
+
+// Prepends the #version line and a GLSL decoder for format to body. The
+// decoder declares attributes 0-3 and 9 and defines
+//   VertexData fetchVertex();   // position, color, uv, layer, normal
+std::string vertexShaderSource(VertexFormat format, const char* body);
+
+// Per-instance attributes, streamed as vertex attributes with divisor 1. The
+// layout also matches the std140 "Object" uniform block of the per-object path.
+struct InstanceData {
+    glm::mat4 model;
+    float layer;        // texture array layer
+    float pad[3];
+};
+static_assert(sizeof(InstanceData) == 80, "InstanceData must match the std140 Object block");
+
+// Where a mesh lives inside the pool's shared buffers; the fields map
+// directly onto a glDrawElements*BaseVertex call or an indirect command.
+struct MeshRange {
+    GLuint firstIndex = 0;
+    GLsizei indexCount = 0;
+    GLint baseVertex = 0;
+};
+
+// Every mesh's vertices and indices suballocated from one large vertex
+// buffer and one index buffer, with a single VAO that also reads a shared
+// per-frame instance buffer (attributes 4-8). Any pooled mesh can be drawn
+// without rebinding, which is what lets multi-draw indirect submit a whole
+// scene in one call. All meshes in a pool share its vertex format and index
+// type; use one pool per combination. Indices are relative to each mesh's
+// base vertex, so a 16-bit pool holds any number of meshes of up to 65536
+// vertices. Capacity is fixed at init(), which fails if the buffers cannot
+// be allocated; add() fails when full.
+struct MeshPool {
+    bool init(VertexFormat format, size_t maxVertices, size_t maxIndices, GLenum indexType = GL_UNSIGNED_INT);
+    void destroy();
+
+    // Indices are relative to the mesh's own first vertex; 16-bit pools
+    // narrow them on upload.
+    bool add(const Vertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount,
+             MeshRange& range);
+    // Runs optimizeMesh() first and prints its report under name.
+    bool addOptimized(const char* name, std::vector<Vertex> vertices, std::vector<uint32_t> indices, MeshRange& range);
+    // Replaces the instance buffer contents; instance i is read by draws
+    // whose first instance is i.
+    void uploadInstances(const InstanceData* instances, size_t count);
+    // Points the instance attributes at firstInstance, for drivers that
+    // cannot offset them with a base instance. Call with the VAO bound.
+    void setInstanceOffset(GLuint firstInstance);
+
+    // Sets material table rows 1 to count; row 0 stays layer 0. Fails if
+    // count does not fit maxPoolMaterials.
+    bool setMaterialLayers(const float* layers, size_t count);
+
+    // Binds the VAO, the material table and, for compact formats, the mesh
+    // table.
+    void bind();
+    // Both call bind().
+    void draw(const MeshRange& mesh);
+    void drawInstanced(const MeshRange& mesh, GLsizei instanceCount);
+
+    size_t indexSize() const { return indexType == GL_UNSIGNED_SHORT ? 2 : 4; }
+    const void* indexOffset(GLuint firstIndex) const { return (const void*)(size_t(firstIndex) * indexSize()); }
+
+    VertexFormat format = VertexFormat::Float;
+    GLenum indexType = GL_UNSIGNED_INT;
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    GLuint ebo = 0;
+    GLuint instanceVbo = 0;
+    GLuint meshTable = 0;    // uniform buffer, compact formats only
+    GLuint materialTable = 0;    // uniform buffer
+    size_t meshCount = 0;
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    size_t vertexCapacity = 0;
+    size_t indexCapacity = 0;
+    size_t instanceCapacity = 0;
+};
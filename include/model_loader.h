@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "mesh_pool.h"
+
+// Triangle geometry read from a model file, in the form MeshPool::add()
+// takes. Every primitive of the file is merged into one mesh; glTF node
+// transforms are applied. Vertices the file gives no normal get a smooth
+// normal from the surrounding faces, and the colour defaults to white.
+struct ModelData {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+// Both parsers read the bytes in place (the file is memory-mapped by
+// loadModel()) and never copy the text or binary chunk. name is only used in
+// error messages, which go to std::cerr.
+//   OBJ   v (with optional r g b), vt, vn and f with any polygon size and
+//         negative indices; other statements are ignored.
+//   GLB   glTF 2.0 binary container with the buffer embedded; triangle
+//         primitives with float, normalized byte or normalized short
+//         attributes.
+bool parseObj(const char* text, size_t size, const char* name, ModelData& model);
+bool parseGlb(const unsigned char* data, size_t size, const char* name, ModelData& model);
+
+// Maps path and picks the parser from its extension (.obj or .glb).
+bool loadModel(const std::string& path, ModelData& model);
+
+// Scales and moves model so its bounds fit a size-sized cube standing on
+// the origin, for placing arbitrary assets in the room.
+void fitModel(ModelData& model, float size);
@@ -0,0 +1,15 @@
+#pragma once
+#include <GL/glew.h>
+
+// Framebuffer object used as the render target in headless mode so the
+// resolution does not depend on a window or display.
+struct OffscreenTarget {
+    GLuint fbo = 0;
+    GLuint color = 0;
+    GLuint depth = 0;
+    int width = 0;
+    int height = 0;
+};
+
+bool createOffscreenTarget(OffscreenTarget& target, int width, int height);
+void destroyOffscreenTarget(OffscreenTarget& target);
@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+
+// Command line settings. Defaults reproduce the interactive 800x600 window.
+struct Options {
+    bool headless = false;   // render into an offscreen framebuffer, no visible window
+    int width = 800;
+    int height = 600;
+    int frames = 0;          // stop after this many frames, 0 runs until quit
+    int tickRate = 120;      // fixed simulation rate in Hz, independent of frame rate
+    int threads = 0;         // job system threads including the main one, 0 uses every core
+    int crates = 0;          // instanced stress scene size, 0 disables it
+    int rigidBodies = 0;     // dynamic physics boxes dropped into the room
+    bool perObjectDraws = false; // draw crates one at a time instead of instanced
+    bool linearCull = false; // cull with a SIMD scan instead of the BVH
+    bool multiDrawIndirect = false; // submit the room and crates with one indirect multi-draw
+    double textureBudgetMb = 0.0; // evict mips above this much texture memory, 0 is unlimited
+    std::string vertexFormat = "compact"; // float, compact or compact-color, see mesh_pool.h
+    std::string levelPath;   // converted level, empty finds room.lvl next to the executable
+    std::string modelPath;   // .obj or .glb model placed in the middle of the room
+    std::string csvPath;     // optional per-frame timing dump
+    std::string benchmarkPath; // fly the scripted camera path and write JSON results here
+    std::string tracePath;   // record profiler zones, written on F9 and at exit
+    std::string shaderCacheDir; // program binary cache, empty uses the SDL pref path
+    bool noShaderCache = false; // always compile shaders, e.g. to time cold startup
+};
+
+bool parseOptions(int argc, char** argv, Options& opts);
+void printUsage(const char* exe);
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "mapped_file.h"
+#include "pak_format.h"
+
+// Memory-mapped pak archive. open() validates the table of contents once;
+// after that a lookup is one hash and, usually, one probe, and never touches
+// the filesystem. Safe to read from several threads once open.
+struct PakArchive {
+    bool open(const std::string& path);
+    bool isOpen() const { return file.isOpen(); }
+    size_t size() const { return header ? header->entryCount : 0; }
+
+    // nullptr if there is no entry called name (or no archive open).
+    const PakEntry* find(std::string_view name) const;
+    // Entries whose name starts with prefix, in name order.
+    std::vector<const PakEntry*> list(std::string_view prefix) const;
+    std::string_view name(const PakEntry& entry) const;
+
+    // The entry's size() bytes: in place for stored entries, otherwise
+    // decompressed into scratch. nullptr if the data is corrupt.
+    const unsigned char* bytes(const PakEntry& entry, std::vector<unsigned char>& scratch) const;
+
+private:
+    MappedFile file;
+    const PakHeader* header = nullptr;
+    const PakEntry* entries = nullptr;
+    const uint32_t* buckets = nullptr;
+    const char* names = nullptr;
+};
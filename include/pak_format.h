@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+// On-disk layout of pak archives (*.pak), written by the pakbuild tool and
+// mapped by PakArchive. One file replaces a directory tree: names are looked
+// up by hash in an open-addressed table of contents, and entry data sits at
+// aligned offsets so stored (uncompressed) entries can be used in place.
+// Little-endian, no padding between fields.
+constexpr uint32_t pakMagic = 0x4B415046;   // "FPAK"
+constexpr uint32_t pakVersion = 1;
+constexpr uint32_t pakDataAlignment = 64;
+constexpr uint32_t pakEmptyBucket = 0xFFFFFFFFu;
+
+enum PakCompression : uint32_t {
+    PakStored = 0,
+    PakBlock = 1,   // LZ4 block format, see block_compress.h
+};
+
+struct PakHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t bucketCount;      // power of two, at least twice entryCount
+    uint64_t entriesOffset;    // PakEntry[entryCount], sorted by name
+    uint64_t bucketsOffset;    // uint32_t[bucketCount]: entry index or pakEmptyBucket
+    uint64_t namesOffset;      // every name back to back, no terminators
+    uint64_t namesSize;
+};
+
+struct PakEntry {
+    uint64_t nameHash;         // pakHash() of the name
+    uint32_t nameOffset;       // into the name block
+    uint32_t nameLength;
+    uint64_t offset;           // data, from the start of the file
+    uint64_t storedSize;       // bytes in the archive
+    uint64_t size;             // bytes once decompressed
+    uint32_t compression;      // PakCompression
+    uint32_t reserved;
+};
+
+static_assert(sizeof(PakHeader) == 48, "pak header layout");
+static_assert(sizeof(PakEntry) == 48, "pak entry layout");
+
+// FNV-1a over the entry name. Names use forward slashes and are relative to
+// the packed root, e.g. "images/no_texture.png". The table of contents is
+// probed linearly from hash & (bucketCount - 1).
+constexpr uint64_t pakHash(std::string_view name) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (char c : name) h = (h ^ uint64_t(uint8_t(c))) * 0x100000001b3ull;
+    return h;
+}
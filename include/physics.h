@@ -0,0 +1,84 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "job_system.h"
+#include "player.h"
+
+class btBroadphaseInterface;
+class btCollisionConfiguration;
+class btCollisionDispatcher;
+class btCollisionShape;
+class btConstraintSolver;
+class btDefaultMotionState;
+class btDiscreteDynamicsWorld;
+class btITaskScheduler;
+class btRigidBody;
+
+// Owns a Bullet dynamics world and everything added to it. With
+// FPS_BULLET_MT (Bullet built with BT_THREADSAFE) the world is the
+// multithreaded btDiscreteDynamicsWorldMt, whose island solving and
+// narrowphase loops run on the engine's job system.
+struct PhysicsWorld {
+    PhysicsWorld();
+    ~PhysicsWorld();
+    PhysicsWorld(const PhysicsWorld&) = delete;
+    PhysicsWorld& operator=(const PhysicsWorld&) = delete;
+
+    bool init(JobSystem& jobs);
+    bool multithreaded() const;
+
+    void addStaticBox(const glm::vec3& center, const glm::vec3& halfExtents);
+    // Returns the index used by bodyModel().
+    size_t addDynamicBox(const glm::vec3& center, const glm::vec3& halfExtents, float mass);
+    size_t dynamicBodyCount() const { return dynamicBodies.size(); }
+    // World transform scaled to the box size, for drawing a unit cube.
+    glm::mat4 bodyModel(size_t i) const;
+
+    // Advances exactly dt; callers provide the fixed tick.
+    void step(float dt);
+    std::vector<double> stepMs;   // wall time of every step
+
+    btDiscreteDynamicsWorld* world() const { return dynamics.get(); }
+    btRigidBody* addBody(btCollisionShape* shape, const glm::vec3& center, float mass);
+    btCollisionShape* boxShape(const glm::vec3& halfExtents);
+    btCollisionShape* ownShape(std::unique_ptr<btCollisionShape> shape);
+
+private:
+    std::unique_ptr<btITaskScheduler> scheduler;   // multithreaded builds only
+    std::unique_ptr<btCollisionConfiguration> config;
+    std::unique_ptr<btCollisionDispatcher> dispatcher;
+    std::unique_ptr<btBroadphaseInterface> broadphase;
+    std::unique_ptr<btConstraintSolver> solverPool;   // multithreaded builds only
+    std::unique_ptr<btConstraintSolver> solver;
+    std::unique_ptr<btDiscreteDynamicsWorld> dynamics;
+    std::vector<std::unique_ptr<btCollisionShape>> shapes;
+    std::vector<std::pair<glm::vec3, btCollisionShape*>> boxShapes;
+    std::vector<std::unique_ptr<btDefaultMotionState>> motionStates;
+    std::vector<std::unique_ptr<btRigidBody>> bodies;
+    std::vector<btRigidBody*> dynamicBodies;
+    std::vector<glm::vec3> dynamicHalfExtents;
+};
+
+// Capsule rigid body moved by setting its horizontal velocity from input;
+// gravity, jumping and collisions with the world are left to Bullet.
+struct CharacterController {
+    static constexpr float radius = 0.3f;
+    static constexpr float cylinderHeight = 0.6f;   // capsule is 1.2 m tall
+    static constexpr float eyeOffset = 0.4f;       // eye above the capsule centre
+    static constexpr float speed = 5.0f;
+    static constexpr float jumpSpeed = 5.0f;
+
+    void init(PhysicsWorld& world, const glm::vec3& eyePosition);
+    // Call once per tick before PhysicsWorld::step.
+    void update(const PlayerInput& input);
+    glm::vec3 eyePosition() const;
+    glm::vec3 velocity() const;
+    bool onGround() const;
+
+private:
+    PhysicsWorld* physics = nullptr;
+    btRigidBody* body = nullptr;
+};
@@ -0,0 +1,15 @@
+#pragma once
+#include <SDL.h>
+#include <glm/glm.hpp>
+#include "camera.h"
+
+// Movement intent sampled once per rendered frame and consumed by every
+// simulation tick that runs during that frame.
+struct PlayerInput {
+    glm::vec3 move{0.0f};   // normalized horizontal direction, or zero
+    bool jump = false;
+};
+
+// Applies mouse look to the camera immediately (look latency should not
+// depend on the tick rate) and returns the movement keys relative to it.
+PlayerInput processInput(Camera& cam, const Uint8* keystate, int dx, int dy);
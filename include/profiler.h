@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Scoped CPU zones recorded per thread and exported as Chrome trace event
+// JSON (open in chrome://tracing or ui.perfetto.dev). Build with
+// -DFPS_PROFILER=0 to compile every zone out.
+#ifndef FPS_PROFILER
+#define FPS_PROFILER 1
+#endif
+
+#if FPS_PROFILER
+
+void profilerSetEnabled(bool enabled);
+bool profilerEnabled();
+// Label for the calling thread in the trace viewer.
+void profilerSetThreadName(const char* name);
+// Writes every zone recorded since the last clear. Safe to call while other
+// threads keep recording.
+bool profilerWriteTrace(const std::string& path);
+void profilerClear();
+uint64_t profilerNowNs();
+// Records an already measured zone on a named track, e.g. GPU pass times
+// converted to the profiler clock.
+void profilerAddZone(const char* track, const char* name, uint64_t startNs, uint64_t durationNs);
+
+struct ProfileZone {
+    // name must outlive the capture; string literals are expected.
+    explicit ProfileZone(const char* name);
+    ~ProfileZone();
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+    const char* name;
+    uint64_t startNs;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone_, __LINE__)(name)
+
+#else
+
+inline void profilerSetEnabled(bool) {}
+inline bool profilerEnabled() { return false; }
+inline void profilerSetThreadName(const char*) {}
+inline bool profilerWriteTrace(const std::string&) { return false; }
+inline void profilerClear() {}
+inline uint64_t profilerNowNs() { return 0; }
+inline void profilerAddZone(const char*, const char*, uint64_t, uint64_t) {}
+
+#define PROFILE_ZONE(name) ((void)0)
+
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "bvh.h"
+#include "frustum.h"
+#include "instancing.h"
+#include "job_system.h"
+
+// Flat list of renderable objects. Bounding spheres are kept as separate
+// arrays (structure of arrays) so culling streams through exactly the data
+// it needs and can test four objects per SIMD instruction.
+struct Scene {
+    std::vector<float> centerX, centerY, centerZ, radius;
+    std::vector<InstanceData> instances;   // render data, same index as the bounds
+    Bvh bvh;                               // optional, over the sphere bounds
+
+    size_t size() const { return instances.size(); }
+    size_t add(const InstanceData& instance, const glm::vec3& center, float r);
+    // Adds instances of a mesh whose vertices fit in a sphere of localRadius
+    // around the mesh origin; the world sphere follows each model matrix.
+    void addInstances(const std::vector<InstanceData>& list, float localRadius);
+    // Moves a rigid object; its radius is unchanged. Call refitBvh() after.
+    void setTransform(size_t i, const glm::mat4& model);
+    void clear();
+
+    // Builds the hierarchy over the current objects; refitBvh() after moving
+    // them, buildBvh() again after adding or removing any.
+    void buildBvh();
+    void refitBvh();
+
+private:
+    std::vector<Aabb> sphereBoxes() const;
+};
+
+// Writes the indices of objects intersecting the frustum to visible (which
+// is cleared first) and returns how many there are. Uses the BVH when one is
+// built, otherwise a SIMD linear scan over the bounds, split across jobs
+// when a job system is given.
+size_t cullScene(const Scene& scene, const Frustum& frustum, std::vector<uint32_t>& visible,
+                 JobSystem* jobs = nullptr);
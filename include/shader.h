@@ -0,0 +1,65 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct ProgramCache;
+
+GLuint compileShader(GLenum type, const char* src);
+// retrievable asks the driver to keep the binary for glGetProgramBinary.
+GLuint createProgram(const char* vsSrc, const char* fsSrc, bool retrievable = false);
+// GLSL 3.30 has no layout(binding); assigns the block's binding point after
+// linking. Programs without the block are left alone.
+void bindUniformBlock(GLuint program, const char* block, GLuint binding);
+
+// Fragment shader for stand-in programs: the interpolated vColor, no
+// textures, so it compiles fast and needs nothing bound.
+extern const char* const fallbackFsSrc;
+
+// Compiles many programs without a stall per shader. submit() issues every
+// compile, then every link, before querying any status, so a driver with
+// compiler threads works on all of them at once. With
+// GL_KHR_parallel_shader_compile, poll() asks for completion without
+// blocking; without it, poll() finishes everything at the first call.
+// A program may name another entry of the batch as its fallback; add the
+// fallback first so it is compiled first. Until a program is ready,
+// program() returns its fallback's program, or 0 while that is not ready
+// either; callers skip drawing with 0. The batch owns every program it
+// hands out.
+struct ShaderBatch {
+    ~ShaderBatch() { destroy(); }
+
+    static constexpr size_t noFallback = SIZE_MAX;
+
+    size_t add(const char* vsSrc, const char* fsSrc, size_t fallback = noFallback);
+    // Applied to each program as it becomes ready.
+    void bindUniformBlock(const char* block, GLuint binding);
+    void submit(ProgramCache* cache);
+    // Returns how many programs became ready during this call.
+    size_t poll();
+    void finish();
+    bool done() const { return readyCount == entries.size(); }
+    bool ready(size_t handle) const { return entries[handle].ready; }
+    GLuint program(size_t handle) const;
+    bool parallel() const { return parallelCompile; }
+    void destroy();
+
+private:
+    struct Entry {
+        std::string vsSrc, fsSrc;
+        size_t fallback = noFallback;
+        GLuint vs = 0, fs = 0, program = 0;
+        bool fromCache = false;
+        bool ready = false;
+    };
+    void complete(Entry& e);
+
+    std::vector<Entry> entries;
+    std::vector<std::pair<std::string, GLuint>> blockBindings;
+    ProgramCache* cache = nullptr;
+    size_t readyCount = 0;
+    bool parallelCompile = false;
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Persistent cache of linked program binaries. Entries are keyed by a hash
+// of the shader sources and the driver's vendor, renderer and version
+// strings, so a driver update or an edited shader simply misses. A binary
+// the driver refuses to load is deleted and the program is compiled again.
+struct ProgramCache {
+    // Disabled (every load compiles) when dir is empty, the directory cannot
+    // be created or the driver offers no program binary formats.
+    bool init(const std::string& dir);
+    GLuint load(const char* vsSrc, const char* fsSrc);
+    bool enabled() const { return !directory.empty(); }
+
+    // The two halves of load(), for callers that link asynchronously:
+    // loadCached() returns 0 on a miss; store() saves a linked program that
+    // was created with the retrievable hint.
+    GLuint loadCached(const char* vsSrc, const char* fsSrc);
+    void store(GLuint program, const char* vsSrc, const char* fsSrc);
+
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t rejected = 0;   // binaries the driver refused
+
+private:
+    uint64_t key(const char* vsSrc, const char* fsSrc) const;
+    std::string pathFor(uint64_t key) const;
+    GLuint loadBinary(uint64_t key, const std::string& path);
+    void writeBinary(GLuint program, uint64_t key, const std::string& path);
+
+    std::string directory;
+    std::string driver;   // vendor, renderer and version, part of every key
+};
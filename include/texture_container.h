@@ -0,0 +1,42 @@
+#pragma once
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+#include "texture_format.h"
+
+// Memory-mapped cooked texture container. Level data is uploaded straight
+// from the mapping; nothing is decoded and no mips are generated at runtime.
+struct TextureContainer {
+    bool open(const std::string& path);
+    // Uses a container already in memory, e.g. a stored pak entry. data must
+    // outlive the container; name is only used in error messages.
+    bool open(const unsigned char* data, size_t size, const std::string& name);
+
+    size_t count() const { return header ? header->textureCount : 0; }
+    const CookedTextureEntry& entry(size_t i) const { return entries[i]; }
+    const unsigned char* levelData(size_t i, uint32_t level) const {
+        return base + entries[i].levelOffset[level];
+    }
+
+    // True if entries a and b have the same size and identical levels.
+    bool sameContent(size_t a, size_t b) const;
+
+    // Picks the entries whose name starts with prefix for the layers of one
+    // array, in container order. Entries whose size differs from the first
+    // match are skipped, and entries with identical pixels share a layer.
+    // names receives every picked entry's name and nameLayers the layer it
+    // ended up in. Returns the entry stored in each layer.
+    std::vector<size_t> arrayLayers(const std::string& prefix, std::vector<std::string>& names,
+                                    std::vector<uint32_t>& nameLayers) const;
+    // Packs the given entries, which must share a size, into the layers of
+    // one GL_TEXTURE_2D_ARRAY. Returns 0 if layers is empty or exceeds the
+    // GL texture size or layer limits.
+    GLuint uploadArray(const std::vector<size_t>& layers) const;
+
+private:
+    MappedFile file;
+    const unsigned char* base = nullptr;
+    const CookedTextureHeader* header = nullptr;
+    const CookedTextureEntry* entries = nullptr;
+};
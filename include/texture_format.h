@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+
+// On-disk layout of cooked texture containers (*.ftc), written by the
+// texcook tool and mapped directly by TextureContainer. Every mip level is
+// stored tightly packed in the layout glTexImage2D expects, so loading is a
+// pointer lookup plus an upload. Little-endian, no padding between fields.
+constexpr uint32_t cookedTextureMagic = 0x43544646;   // "FFTC"
+constexpr uint32_t cookedTextureVersion = 1;
+constexpr uint32_t cookedTextureMaxLevels = 16;
+constexpr uint32_t cookedTextureNameLength = 48;
+constexpr uint32_t cookedTextureDataAlignment = 64;
+
+enum CookedTextureFormat : uint32_t {
+    CookedRGBA8 = 1,
+};
+
+struct CookedTextureHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t textureCount;   // entries follow the header directly
+    uint32_t reserved;
+};
+
+struct CookedTextureEntry {
+    char name[cookedTextureNameLength];   // file stem, NUL terminated
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    uint32_t format;
+    uint64_t levelOffset[cookedTextureMaxLevels];   // from the start of the file
+    uint32_t levelSize[cookedTextureMaxLevels];
+};
+
+static_assert(sizeof(CookedTextureHeader) == 16, "cooked texture header layout");
+static_assert(sizeof(CookedTextureEntry) == 256, "cooked texture entry layout");
@@ -0,0 +1,60 @@
+#pragma once
+#include <GL/glew.h>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "job_system.h"
+
+struct PakArchive;
+
+// Streams same-sized images into the layers of one GL_TEXTURE_2D_ARRAY
+// without blocking the first frame. The array is created up front with every
+// layer grey, background jobs decode the files in parallel, and the GL thread
+// uploads finished images through pixel buffer objects from pump(). Layer i
+// holds paths[i]; callers can reference layers immediately and they switch
+// to the real image once it has been uploaded.
+struct TextureStreamer {
+    static constexpr int pboCount = 3;
+
+    ~TextureStreamer() { stop(); }
+
+    // The array size comes from the first file's header; files with other
+    // dimensions are rejected and keep the placeholder. With a pak, paths
+    // are entry names and images decode from the archive; it must stay open
+    // until stop().
+    bool start(const std::vector<std::string>& paths, JobSystem& jobs, const PakArchive* pak = nullptr);
+    // GL thread only. Uploads at most maxUploads images, returns how many.
+    size_t pump(size_t maxUploads);
+    bool done() const { return uploaded + failed.load() == paths.size(); }
+    void stop();
+
+    size_t layerCount() const { return paths.size(); }
+
+    GLuint array = 0;
+    int width = 0;
+    int height = 0;
+
+private:
+    struct Decoded {
+        size_t index;
+        unsigned char* pixels;   // RGBA8 width x height, owned by stb_image
+    };
+
+    void decode(size_t index);
+    void upload(const Decoded& image);
+
+    std::vector<std::string> paths;
+    const PakArchive* pak = nullptr;
+    JobSystem* jobs = nullptr;
+    JobCounter decodeJobs;
+    std::atomic<size_t> failed{0};
+    std::atomic<bool> cancel{false};
+    std::mutex readyMutex;
+    std::deque<Decoded> ready;
+    GLuint pbos[pboCount] = {};
+    int nextPbo = 0;
+    size_t uploaded = 0;
+};
@@ -0,0 +1,106 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct TextureContainer;
+
+// 64-bit hash of texel data, used to find textures (or array layers) whose
+// decoded contents are identical. Chain calls through seed to hash several
+// levels as one key.
+uint64_t hashTextureContent(const void* data, size_t size, uint64_t seed = 0);
+
+// Owns the engine's GL textures. Textures are keyed by content hash, so
+// loading the same pixels twice shares one texture, and are reference
+// counted: release() deletes a texture once nothing uses it. Resident bytes
+// are tracked per texture. With a budget set, enforceBudget() drops the most
+// detailed mip levels of textures that have not been used for idleFrames,
+// least recently used first, until the total fits; dropped levels are
+// respecified empty so the driver frees them, and sampling clamps to the
+// levels that remain. Textures in use are never cut.
+//
+// Textures must be RGBA8 with mutable (glTexImage) storage and a full or
+// partial mip chain from level 0. GL thread only.
+struct TextureManager {
+    using Handle = uint32_t;
+    static constexpr Handle invalid = 0;
+
+    // A live texture with this content hash, with a reference added, or
+    // invalid if there is none; the caller then uploads and calls add().
+    Handle acquire(uint64_t contentHash);
+    // Takes ownership of texture with one reference. contentHash 0 opts out
+    // of sharing (e.g. contents that are still streaming in).
+    Handle add(const std::string& name, GLuint texture, GLenum target, uint64_t contentHash,
+               uint32_t width, uint32_t height, uint32_t layers, uint32_t levelCount);
+    void addRef(Handle handle);
+    void release(Handle handle);
+    // Deletes every texture regardless of references, at shutdown.
+    void releaseAll();
+
+    GLuint texture(Handle handle) const { return textures[handle].texture; }
+    // Marks a texture as used this frame for LRU eviction.
+    void touch(Handle handle) { textures[handle].lastUsed = frame; }
+    void beginFrame() { ++frame; }
+
+    // 0 disables eviction.
+    void setBudget(size_t bytes) { budget = bytes; }
+    // Evicts mips of idle textures until resident bytes fit the budget.
+    // Returns the bytes freed. Cheap to call every frame: when the budget
+    // cannot be met it does not look again until another texture could
+    // have gone idle.
+    size_t enforceBudget();
+
+    size_t residentBytes() const { return resident; }
+    size_t liveCount() const { return live; }
+    void printReport(std::ostream& out) const;
+
+    // Levels at or below this size are never evicted.
+    static constexpr uint32_t minEvictedSize = 16;
+    // Frames without touch() before a texture's mips may be evicted.
+    static constexpr uint64_t idleFrames = 300;
+
+    size_t shared = 0;           // acquire() calls answered by an existing texture
+    size_t evictedLevels = 0;
+
+private:
+    struct Entry {
+        std::string name;
+        GLuint texture = 0;
+        GLenum target = 0;
+        uint64_t contentHash = 0;
+        uint32_t width = 0, height = 0, layers = 0;
+        uint32_t levelCount = 0;
+        uint32_t baseLevel = 0;  // levels below this have been evicted
+        uint32_t refs = 0;
+        uint64_t lastUsed = 0;
+        size_t bytes = 0;        // resident levels only
+    };
+
+    static size_t levelBytes(const Entry& e, uint32_t level);
+    bool evictLevel(Entry& e);
+
+    // Slot 0 is never used so that invalid can be 0; freed slots are reused.
+    std::vector<Entry> textures = std::vector<Entry>(1);
+    std::vector<Handle> freeSlots;
+    std::unordered_map<uint64_t, Handle> byContent;
+    uint64_t frame = 0;
+    size_t budget = 0;
+    uint64_t nextCheck = 0;      // frame at which enforceBudget() looks again
+    size_t resident = 0;
+    size_t live = 0;
+};
+
+// Content hash of a cooked container entry, covering its size and every
+// level.
+uint64_t cookedContentHash(const TextureContainer& container, size_t i);
+// Uploads the prefix array through the manager: an array holding the same
+// pixels is shared instead of uploaded again. See
+// TextureContainer::arrayLayers() for names and nameLayers. Returns invalid
+// if nothing matched prefix.
+TextureManager::Handle uploadCookedArray(TextureManager& textures, const TextureContainer& container,
+                                         const std::string& prefix, std::vector<std::string>& names,
+                                         std::vector<uint32_t>& nameLayers);
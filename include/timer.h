@@ -0,0 +1,12 @@
+#pragma once
+#include <SDL.h>
+
+// High resolution wall clock helpers built on SDL's performance counter.
+inline double ticksToMs(Uint64 ticks) {
+    static const double msPerTick = 1000.0 / double(SDL_GetPerformanceFrequency());
+    return double(ticks) * msPerTick;
+}
+
+inline double elapsedMs(Uint64 start, Uint64 end) {
+    return ticksToMs(end - start);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+// Uniform block binding points shared by every program.
+constexpr GLuint frameUniformBinding = 0;    // FrameUniforms
+constexpr GLuint objectUniformBinding = 1;   // one object's constants
+
+// std140 layout of the "Frame" block.
+struct FrameUniforms {
+    glm::mat4 viewProj;
+};
+
+// Per-frame uniform data in one buffer split into frameCount regions. A
+// frame writes its constants linearly into its region and binds them by
+// offset; the region is fenced at endFrame() and only reused once the GPU
+// has passed that fence, so writes never stall on draws still in flight.
+//
+// With GL 4.4 / ARB_buffer_storage the buffer is persistently and coherently
+// mapped and allocate() writes straight into it. Otherwise allocate() fills
+// a staging copy and upload() sends the new bytes with glBufferSubData.
+// Either way, call upload() after allocating and before drawing.
+struct UniformRing {
+    static constexpr int frameCount = 3;
+
+    bool init(size_t bytesPerFrame);
+    void shutdown();
+
+    void beginFrame();
+    // Copies size bytes and returns their offset in buffer, aligned for
+    // glBindBufferRange, or -1 when the frame's region is full.
+    GLintptr allocate(const void* data, size_t size);
+    void upload();
+    void endFrame();
+
+    size_t frameBytes() const { return head; }
+    bool persistent() const { return mapped != nullptr; }
+
+    GLuint buffer = 0;
+    double lastWaitMs = 0.0;   // time beginFrame() blocked on the GPU
+    size_t overflows = 0;
+
+private:
+    size_t alignment = 256;
+    size_t regionSize = 0;
+    int current = 0;
+    size_t head = 0;        // bytes used in the current region
+    size_t uploaded = 0;    // staging bytes already sent
+    unsigned char* mapped = nullptr;
+    std::vector<unsigned char> staging;
+    GLsync fences[frameCount] = {};
+};
@@ -0,0 +1,118 @@
+#include "block_compress.h"
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+constexpr size_t minMatch = 4;
+constexpr size_t lastLiterals = 5;    // the block always ends with literals
+constexpr size_t matchLimit = 12;     // no match may start this close to the end
+constexpr size_t maxOffset = 65535;
+constexpr int hashBits = 16;
+
+uint32_t read32(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t hash4(uint32_t v) {
+    return (v * 2654435761u) >> (32 - hashBits);
+}
+
+// Lengths of 15 or more continue in bytes of 255 plus a remainder.
+void writeLength(std::vector<unsigned char>& out, size_t length) {
+    for (; length >= 255; length -= 255) out.push_back(255);
+    out.push_back((unsigned char)length);
+}
+
+void writeSequence(std::vector<unsigned char>& out, const unsigned char* literals, size_t literalCount,
+                   size_t offset, size_t matchLength) {
+    const size_t matchCode = matchLength ? matchLength - minMatch : 0;
+    out.push_back((unsigned char)((literalCount < 15 ? literalCount : 15) << 4 | (matchCode < 15 ? matchCode : 15)));
+    if (literalCount >= 15) writeLength(out, literalCount - 15);
+    out.insert(out.end(), literals, literals + literalCount);
+    if (!matchLength) return;   // final literal run
+    out.push_back((unsigned char)(offset & 0xFF));
+    out.push_back((unsigned char)(offset >> 8));
+    if (matchCode >= 15) writeLength(out, matchCode - 15);
+}
+
+} // namespace
+
+void blockCompress(const unsigned char* src, size_t size, std::vector<unsigned char>& out) {
+    out.clear();
+    out.reserve(size + size / 255 + 16);
+    size_t anchor = 0;
+    if (size > matchLimit) {
+        // Last position seen for each hash, plus one so zero means empty.
+        std::vector<uint32_t> table(size_t(1) << hashBits, 0);
+        const size_t matchStartEnd = size - matchLimit;
+        const size_t matchEnd = size - lastLiterals;
+        size_t ip = 0;
+        while (ip <= matchStartEnd) {
+            const uint32_t sequence = read32(src + ip);
+            uint32_t& slot = table[hash4(sequence)];
+            const size_t candidate = slot;
+            slot = uint32_t(ip + 1);
+            if (candidate == 0 || ip - (candidate - 1) > maxOffset || read32(src + candidate - 1) != sequence) {
+                ++ip;
+                continue;
+            }
+            size_t ref = candidate - 1;
+            size_t length = minMatch;
+            while (ip + length < matchEnd && src[ref + length] == src[ip + length]) ++length;
+            // Extend backwards over literals that also match.
+            while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1]) {
+                --ip;
+                --ref;
+                ++length;
+            }
+            writeSequence(out, src + anchor, ip - anchor, ip - ref, length);
+            ip += length;
+            anchor = ip;
+        }
+    }
+    writeSequence(out, src + anchor, size - anchor, 0, 0);
+}
+
+bool blockDecompress(const unsigned char* src, size_t srcSize, unsigned char* dst, size_t dstSize) {
+    size_t ip = 0, op = 0;
+    auto readLength = [&](size_t& length) {
+        unsigned char b;
+        do {
+            if (ip >= srcSize) return false;
+            b = src[ip++];
+            length += b;
+        } while (b == 255);
+        return true;
+    };
+    while (ip < srcSize) {
+        const unsigned char token = src[ip++];
+        size_t literals = token >> 4;
+        if (literals == 15 && !readLength(literals)) return false;
+        if (literals > srcSize - ip || literals > dstSize - op) return false;
+        if (literals) std::memcpy(dst + op, src + ip, literals);
+        ip += literals;
+        op += literals;
+        if (ip == srcSize) break;   // the last sequence has no match
+
+        if (srcSize - ip < 2) return false;
+        const size_t offset = size_t(src[ip]) | size_t(src[ip + 1]) << 8;
+        ip += 2;
+        if (offset == 0 || offset > op) return false;
+        size_t length = token & 15;
+        if (length == 15 && !readLength(length)) return false;
+        length += minMatch;
+        if (length > dstSize - op) return false;
+        const unsigned char* from = dst + op - offset;
+        if (offset >= length) {
+            std::memcpy(dst + op, from, length);
+        } else {
+            // Overlapping copy repeats the last offset bytes.
+            for (size_t i = 0; i < length; ++i) dst[op + i] = from[i];
+        }
+        op += length;
+    }
+    return op == dstSize;
+}
@@ -0,0 +1,238 @@
+#include "bvh.h"
+
+static void grow(Aabb& box, const glm::vec3& p) {
+    box.min = glm::min(box.min, p);
+    box.max = glm::max(box.max, p);
+}
+
+static void grow(Aabb& box, const Aabb& other) {
+    box.min = glm::min(box.min, other.min);
+    box.max = glm::max(box.max, other.max);
+}
+
+static Aabb emptyBox() {
+    return {glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX)};
+}
+
+static float halfArea(const Aabb& box) {
+    glm::vec3 e = box.max - box.min;
+    return e.x * e.y + e.y * e.z + e.z * e.x;
+}
+
+void Bvh::build(const std::vector<Aabb>& primitives) {
+    boxes = primitives;
+    nodes.clear();
+    indices.resize(boxes.size());
+    if (boxes.empty()) return;
+
+    std::vector<glm::vec3> centroids(boxes.size());
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        indices[i] = uint32_t(i);
+        centroids[i] = (boxes[i].min + boxes[i].max) * 0.5f;
+    }
+    nodes.reserve(boxes.size() * 2);
+    nodes.push_back({glm::vec3(0.0f), 0, glm::vec3(0.0f), uint32_t(boxes.size())});
+    updateBounds(0);
+    subdivide(0, centroids, 0);
+    nodes.shrink_to_fit();
+}
+
+void Bvh::updateBounds(uint32_t node) {
+    BvhNode& n = nodes[node];
+    Aabb box = emptyBox();
+    for (uint32_t i = 0; i < n.count; ++i) grow(box, boxes[indices[n.leftFirst + i]]);
+    n.boundsMin = box.min;
+    n.boundsMax = box.max;
+}
+
+void Bvh::subdivide(uint32_t node, const std::vector<glm::vec3>& centroids, int depth) {
+    uint32_t first = nodes[node].leftFirst, count = nodes[node].count;
+    if (count <= maxLeafSize || depth >= maxDepth) return;
+
+    // Binned SAH: drop centroids into equal-width bins per axis and evaluate
+    // the cost of splitting between each pair of neighbouring bins.
+    int bestAxis = -1, bestSplit = 0;
+    float bestCost = FLT_MAX;
+    float bestMin = 0.0f, bestScale = 0.0f;
+    for (int axis = 0; axis < 3; ++axis) {
+        float lo = FLT_MAX, hi = -FLT_MAX;
+        for (uint32_t i = 0; i < count; ++i) {
+            float c = centroids[indices[first + i]][axis];
+            lo = std::min(lo, c);
+            hi = std::max(hi, c);
+        }
+        if (hi <= lo) continue;
+
+        Aabb binBox[binCount];
+        uint32_t binPrims[binCount] = {};
+        for (Aabb& b : binBox) b = emptyBox();
+        float scale = binCount / (hi - lo);
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t prim = indices[first + i];
+            int bin = std::min(binCount - 1, int((centroids[prim][axis] - lo) * scale));
+            ++binPrims[bin];
+            grow(binBox[bin], boxes[prim]);
+        }
+
+        float leftArea[binCount - 1], rightArea[binCount - 1];
+        uint32_t leftCount[binCount - 1], rightCount[binCount - 1];
+        Aabb leftBox = emptyBox(), rightBox = emptyBox();
+        uint32_t leftSum = 0, rightSum = 0;
+        for (int i = 0; i < binCount - 1; ++i) {
+            leftSum += binPrims[i];
+            leftCount[i] = leftSum;
+            grow(leftBox, binBox[i]);
+            leftArea[i] = leftSum ? halfArea(leftBox) : 0.0f;
+
+            rightSum += binPrims[binCount - 1 - i];
+            rightCount[binCount - 2 - i] = rightSum;
+            grow(rightBox, binBox[binCount - 1 - i]);
+            rightArea[binCount - 2 - i] = rightSum ? halfArea(rightBox) : 0.0f;
+        }
+        for (int i = 0; i < binCount - 1; ++i) {
+            float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = i + 1;
+                bestMin = lo;
+                bestScale = scale;
+            }
+        }
+    }
+
+    Aabb nodeBox{nodes[node].boundsMin, nodes[node].boundsMax};
+    if (bestAxis < 0 || bestCost >= count * halfArea(nodeBox)) return;   // a leaf is cheaper
+
+    // Partition the index range so primitives left of the split come first.
+    uint32_t* begin = indices.data() + first;
+    uint32_t* mid = std::partition(begin, begin + count, [&](uint32_t prim) {
+        int bin = std::min(binCount - 1, int((centroids[prim][bestAxis] - bestMin) * bestScale));
+        return bin < bestSplit;
+    });
+    uint32_t leftCount = uint32_t(mid - begin);
+    if (leftCount == 0 || leftCount == count) return;
+
+    uint32_t left = uint32_t(nodes.size());
+    nodes.push_back({glm::vec3(0.0f), first, glm::vec3(0.0f), leftCount});
+    nodes.push_back({glm::vec3(0.0f), first + leftCount, glm::vec3(0.0f), count - leftCount});
+    nodes[node].leftFirst = left;
+    nodes[node].count = 0;
+    updateBounds(left);
+    updateBounds(left + 1);
+    subdivide(left, centroids, depth + 1);
+    subdivide(left + 1, centroids, depth + 1);
+}
+
+void Bvh::refit(const std::vector<Aabb>& primitives) {
+    boxes = primitives;
+    for (size_t i = nodes.size(); i-- > 0;) {
+        BvhNode& n = nodes[i];
+        if (n.count) {
+            updateBounds(uint32_t(i));
+        } else {
+            const BvhNode& l = nodes[n.leftFirst];
+            const BvhNode& r = nodes[n.leftFirst + 1];
+            n.boundsMin = glm::min(l.boundsMin, r.boundsMin);
+            n.boundsMax = glm::max(l.boundsMax, r.boundsMax);
+        }
+    }
+}
+
+// 0 = outside, 1 = intersecting, 2 = fully inside.
+static int classify(const Frustum& f, const glm::vec3& bmin, const glm::vec3& bmax) {
+    int result = 2;
+    for (const glm::vec4& p : f.planes) {
+        // Corner furthest along the plane normal, and the one opposite it.
+        glm::vec3 pos{p.x >= 0.0f ? bmax.x : bmin.x, p.y >= 0.0f ? bmax.y : bmin.y, p.z >= 0.0f ? bmax.z : bmin.z};
+        glm::vec3 neg{p.x >= 0.0f ? bmin.x : bmax.x, p.y >= 0.0f ? bmin.y : bmax.y, p.z >= 0.0f ? bmin.z : bmax.z};
+        if (p.x * pos.x + p.y * pos.y + p.z * pos.z + p.w < 0.0f) return 0;
+        if (p.x * neg.x + p.y * neg.y + p.z * neg.z + p.w < 0.0f) result = 1;
+    }
+    return result;
+}
+
+void Bvh::queryFrustum(const Frustum& frustum, std::vector<uint32_t>& out) const {
+    if (nodes.empty()) return;
+    // Subtrees fully inside the frustum are emitted without further tests.
+    struct Entry { uint32_t node; bool inside; };
+    Entry stack[64];
+    int top = 0;
+    stack[top++] = {0, false};
+    while (top) {
+        Entry e = stack[--top];
+        const BvhNode& n = nodes[e.node];
+        bool inside = e.inside;
+        if (!inside) {
+            int c = classify(frustum, n.boundsMin, n.boundsMax);
+            if (c == 0) continue;
+            inside = c == 2;
+        }
+        if (n.count) {
+            out.insert(out.end(), indices.begin() + n.leftFirst, indices.begin() + n.leftFirst + n.count);
+        } else {
+            stack[top++] = {n.leftFirst + 1, inside};
+            stack[top++] = {n.leftFirst, inside};
+        }
+    }
+}
+
+void Bvh::queryOverlap(const Aabb& box, std::vector<uint32_t>& out) const {
+    if (nodes.empty()) return;
+    uint32_t stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top) {
+        const BvhNode& n = nodes[stack[--top]];
+        if (!overlaps({n.boundsMin, n.boundsMax}, box)) continue;
+        if (n.count) {
+            for (uint32_t i = 0; i < n.count; ++i) {
+                uint32_t prim = indices[n.leftFirst + i];
+                if (overlaps(boxes[prim], box)) out.push_back(prim);
+            }
+        } else {
+            stack[top++] = n.leftFirst + 1;
+            stack[top++] = n.leftFirst;
+        }
+    }
+}
+
+bool Bvh::raycast(const glm::vec3& origin, const glm::vec3& dir, float maxT, BvhHit& hit) const {
+    if (nodes.empty()) return false;
+    glm::vec3 invDir{1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z};
+    float best = maxT;
+    bool found = false;
+
+    uint32_t stack[64];
+    int top = 0;
+    if (intersectRay(origin, invDir, best, nodes[0].boundsMin, nodes[0].boundsMax) == FLT_MAX) return false;
+    stack[top++] = 0;
+    while (top) {
+        const BvhNode& n = nodes[stack[--top]];
+        if (n.count) {
+            for (uint32_t i = 0; i < n.count; ++i) {
+                uint32_t prim = indices[n.leftFirst + i];
+                float t = intersectRay(origin, invDir, best, boxes[prim].min, boxes[prim].max);
+                if (t < best) {
+                    best = t;
+                    hit.index = prim;
+                    hit.t = t;
+                    found = true;
+                }
+            }
+            continue;
+        }
+        // Visit the nearer child first so the far one is more often pruned
+        // by the shrinking best distance.
+        uint32_t a = n.leftFirst, b = n.leftFirst + 1;
+        float ta = intersectRay(origin, invDir, best, nodes[a].boundsMin, nodes[a].boundsMax);
+        float tb = intersectRay(origin, invDir, best, nodes[b].boundsMin, nodes[b].boundsMax);
+        if (ta > tb) {
+            std::swap(a, b);
+            std::swap(ta, tb);
+        }
+        if (tb != FLT_MAX) stack[top++] = b;
+        if (ta != FLT_MAX) stack[top++] = a;
+    }
+    return found;
+}
@@ -0,0 +1,156 @@
+#include "ecs.h"
+#include "profiler.h"
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+
+namespace {
+
+std::mutex g_componentMutex;
+std::vector<size_t> g_componentSizes;
+
+} // namespace
+
+uint32_t registerComponentType(size_t size) {
+    std::lock_guard<std::mutex> lock(g_componentMutex);
+    if (g_componentSizes.size() >= maxComponentTypes) {
+        std::cerr << "Too many component types (max " << maxComponentTypes << ")" << std::endl;
+        std::abort();
+    }
+    g_componentSizes.push_back(size);
+    return uint32_t(g_componentSizes.size() - 1);
+}
+
+size_t componentTypeSize(uint32_t id) {
+    std::lock_guard<std::mutex> lock(g_componentMutex);
+    return g_componentSizes[id];
+}
+
+World::World() {
+    archetypeFor(ComponentMask{});
+}
+
+uint32_t World::archetypeFor(const ComponentMask& mask) {
+    auto it = archetypeIndex.find(mask);
+    if (it != archetypeIndex.end()) return it->second;
+
+    auto a = std::make_unique<Archetype>();
+    a->mask = mask;
+    for (int8_t& c : a->columnOf) c = -1;
+    for (uint32_t id = 0; id < maxComponentTypes; ++id) {
+        if (!mask.test(id)) continue;
+        a->columnOf[id] = int8_t(a->componentIds.size());
+        a->componentIds.push_back(id);
+        a->componentSizes.push_back(componentTypeSize(id));
+        a->columns.emplace_back();
+    }
+    archetypes.push_back(std::move(a));
+    uint32_t index = uint32_t(archetypes.size() - 1);
+    archetypeIndex.emplace(mask, index);
+    return index;
+}
+
+Entity World::allocateEntity() {
+    uint32_t index;
+    if (!freeIndices.empty()) {
+        index = freeIndices.back();
+        freeIndices.pop_back();
+    } else {
+        index = uint32_t(records.size());
+        records.emplace_back();
+    }
+    records[index].alive = true;
+    return {index, records[index].generation};
+}
+
+Entity World::create() {
+    Entity e = allocateEntity();
+    records[e.index].archetype = 0;
+    records[e.index].row = appendRow(*archetypes[0], e);
+    return e;
+}
+
+bool World::alive(Entity e) const {
+    return e.index < records.size() && records[e.index].alive && records[e.index].generation == e.generation;
+}
+
+unsigned char* World::componentPtr(Archetype& a, uint32_t row, uint32_t id) {
+    size_t c = size_t(a.columnOf[id]);
+    return a.columns[c].data() + size_t(row) * a.componentSizes[c];
+}
+
+uint32_t World::appendRow(Archetype& a, Entity e) {
+    uint32_t row = uint32_t(a.entities.size());
+    a.entities.push_back(e);
+    for (size_t c = 0; c < a.columns.size(); ++c)
+        a.columns[c].resize(a.columns[c].size() + a.componentSizes[c]);
+    return row;
+}
+
+void World::removeRow(Archetype& a, uint32_t row) {
+    // Swap the last row into the hole so the arrays stay dense.
+    uint32_t last = uint32_t(a.entities.size() - 1);
+    for (size_t c = 0; c < a.columns.size(); ++c) {
+        size_t size = a.componentSizes[c];
+        std::vector<unsigned char>& column = a.columns[c];
+        if (row != last) std::memcpy(column.data() + size_t(row) * size, column.data() + size_t(last) * size, size);
+        column.resize(column.size() - size);
+    }
+    if (row != last) {
+        a.entities[row] = a.entities[last];
+        records[a.entities[row].index].row = row;
+    }
+    a.entities.pop_back();
+}
+
+void World::moveEntity(Entity e, uint32_t to) {
+    Record& r = records[e.index];
+    Archetype& from = *archetypes[r.archetype];
+    Archetype& dest = *archetypes[to];
+    uint32_t row = appendRow(dest, e);
+    for (size_t c = 0; c < dest.componentIds.size(); ++c) {
+        uint32_t id = dest.componentIds[c];
+        if (from.columnOf[id] >= 0)
+            std::memcpy(componentPtr(dest, row, id), componentPtr(from, r.row, id), dest.componentSizes[c]);
+    }
+    removeRow(from, r.row);
+    r.archetype = to;
+    r.row = row;
+}
+
+void World::destroy(Entity e) {
+    if (!alive(e)) return;
+    Record& r = records[e.index];
+    removeRow(*archetypes[r.archetype], r.row);
+    r.alive = false;
+    ++r.generation;
+    freeIndices.push_back(e.index);
+}
+
+void SystemScheduler::add(const char* name, ComponentMask reads, ComponentMask writes, Fn fn) {
+    systems.push_back({name, reads, writes, false, std::move(fn)});
+}
+
+void SystemScheduler::addExclusive(const char* name, Fn fn) {
+    systems.push_back({name, {}, {}, true, std::move(fn)});
+}
+
+void SystemScheduler::run(World& world, JobSystem& jobs, float dt) {
+    TaskGraph graph;
+    for (System& s : systems) {
+        graph.add([&world, &s, dt] {
+            PROFILE_ZONE(s.name);
+            s.fn(world, dt);
+        });
+    }
+    for (size_t j = 0; j < systems.size(); ++j) {
+        const System& b = systems[j];
+        for (size_t i = 0; i < j; ++i) {
+            const System& a = systems[i];
+            bool conflict = a.exclusive || b.exclusive || (a.writes & (b.reads | b.writes)).any() ||
+                            (b.writes & a.reads).any();
+            if (conflict) graph.precede(i, j);
+        }
+    }
+    jobs.run(graph);
+}
@@ -0,0 +1,50 @@
+#include "flythrough.h"
+#include <cmath>
+
+Flythrough Flythrough::defaultPath() {
+    // Loop around the inside of the 20x5x20 room, dipping towards the
+    // corners and rising near the ceiling so every face gets covered.
+    Flythrough path;
+    path.points = {
+        {-7.0f, 1.0f, -7.0f},
+        { 0.0f, 2.5f, -8.0f},
+        { 7.0f, 1.5f, -7.0f},
+        { 8.0f, 4.0f,  0.0f},
+        { 7.0f, 1.0f,  7.0f},
+        { 0.0f, 3.0f,  8.0f},
+        {-7.0f, 1.5f,  7.0f},
+        {-8.0f, 4.0f,  0.0f},
+    };
+    return path;
+}
+
+static glm::vec3 catmullRom(const glm::vec3& p0, const glm::vec3& p1,
+                            const glm::vec3& p2, const glm::vec3& p3, float t) {
+    float t2 = t * t, t3 = t2 * t;
+    return 0.5f * ((2.0f * p1) +
+                   (p2 - p0) * t +
+                   (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+                   (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+}
+
+glm::vec3 Flythrough::position(float t) const {
+    int n = int(points.size());
+    if (n == 0) return glm::vec3(0.0f);
+    float s = (t - std::floor(t)) * n;
+    int i = int(s) % n;
+    float local = s - std::floor(s);
+    return catmullRom(points[(i + n - 1) % n], points[i],
+                      points[(i + 1) % n], points[(i + 2) % n], local);
+}
+
+void Flythrough::apply(Camera& cam, float t) const {
+    // Look along the path, using a small forward difference for the tangent.
+    glm::vec3 here = position(t);
+    glm::vec3 dir = position(t + 0.002f) - here;
+    cam.position = here;
+    if (glm::length(dir) > 1e-6f) {
+        dir = glm::normalize(dir);
+        cam.yaw = glm::degrees(std::atan2(dir.z, dir.x));
+        cam.pitch = glm::degrees(std::asin(dir.y));
+    }
+}
@@ -0,0 +1,167 @@
+#include "frame_stats.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+TimingSummary summarize(const std::vector<double>& values) {
+    std::vector<double> sorted;
+    sorted.reserve(values.size());
+    for (double v : values)
+        if (v >= 0.0) sorted.push_back(v);
+
+    TimingSummary s;
+    s.count = sorted.size();
+    if (sorted.empty()) return s;
+    std::sort(sorted.begin(), sorted.end());
+
+    // Nearest-rank percentiles: the smallest sample with at least p% of the
+    // samples at or below it.
+    auto rank = [&](double p) {
+        size_t idx = size_t(std::ceil(p * sorted.size()));
+        return sorted[idx ? idx - 1 : 0];
+    };
+    double sum = 0.0;
+    for (double v : sorted) sum += v;
+    s.avg = sum / sorted.size();
+    s.min = sorted.front();
+    s.p50 = rank(0.50);
+    s.p95 = rank(0.95);
+    s.p99 = rank(0.99);
+    s.max = sorted.back();
+    return s;
+}
+
+void FrameStats::recordFrame(double frame, double cpu) {
+    frameMs.push_back(frame);
+    cpuMs.push_back(cpu);
+    gpuMs.push_back(-1.0);
+    for (Series& series : gpuPasses) series.values.push_back(-1.0);
+    for (Series& series : counters) series.values.push_back(-1.0);
+}
+
+void FrameStats::recordGpu(size_t frame, double ms) {
+    if (frame < gpuMs.size()) gpuMs[frame] = ms;
+}
+
+// A series may be fed several times per frame (a pass that runs twice, a
+// counter bumped per batch); the frame reports the sum.
+static void accumulate(std::vector<FrameStats::Series>& list, size_t frames, size_t frame,
+                       const std::string& name, double value) {
+    if (frame >= frames) return;
+    FrameStats::Series* series = nullptr;
+    for (FrameStats::Series& s : list)
+        if (s.name == name) series = &s;
+    if (!series) {
+        list.push_back({name, std::vector<double>(frames, -1.0)});
+        series = &list.back();
+    }
+    double& slot = series->values[frame];
+    slot = slot < 0.0 ? value : slot + value;
+}
+
+void FrameStats::recordGpuPass(size_t frame, const std::string& pass, double ms) {
+    accumulate(gpuPasses, frameCount(), frame, pass, ms);
+}
+
+void FrameStats::recordCounter(size_t frame, const std::string& name, double value) {
+    accumulate(counters, frameCount(), frame, name, value);
+}
+
+std::vector<size_t> FrameStats::histogram() const {
+    std::vector<size_t> counts(histogramBuckets, 0);
+    for (double v : frameMs) {
+        size_t bucket = size_t(v / histogramBucketMs);
+        ++counts[std::min(bucket, histogramBuckets - 1)];
+    }
+    return counts;
+}
+
+static void printSeries(std::ostream& out, const std::string& label, const std::vector<double>& values,
+                        const char* unit = " ms") {
+    TimingSummary s = summarize(values);
+    out << label;
+    if (!s.count) {
+        out << " n/a\n";
+        return;
+    }
+    out << " avg " << s.avg << "  p50 " << s.p50 << "  p95 " << s.p95
+        << "  p99 " << s.p99 << "  max " << s.max << unit << "\n";
+}
+
+void FrameStats::printSummary(std::ostream& out) const {
+    out << std::fixed << std::setprecision(3);
+    out << "Frames: " << frameCount() << "\n";
+    printSeries(out, "  Frame", frameMs);
+    printSeries(out, "  CPU  ", cpuMs);
+    printSeries(out, "  GPU  ", gpuMs);
+    for (const Series& p : gpuPasses) printSeries(out, "    GPU " + p.name, p.values);
+    for (const Series& c : counters) printSeries(out, "  " + c.name, c.values, "");
+}
+
+bool FrameStats::writeCsv(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+    out << "frame,frame_ms,cpu_ms,gpu_ms";
+    for (const Series& p : gpuPasses) out << ",gpu_" << p.name << "_ms";
+    for (const Series& c : counters) out << ',' << c.name;
+    out << '\n';
+    for (size_t i = 0; i < frameMs.size(); ++i) {
+        out << i << ',' << frameMs[i] << ',' << cpuMs[i] << ',';
+        if (gpuMs[i] >= 0.0) out << gpuMs[i];
+        for (const std::vector<Series>* list : {&gpuPasses, &counters}) {
+            for (const Series& series : *list) {
+                out << ',';
+                if (series.values[i] >= 0.0) out << series.values[i];
+            }
+        }
+        out << '\n';
+    }
+    return true;
+}
+
+static void writeSummaryJson(std::ostream& out, const TimingSummary& s) {
+    out << "{\"count\": " << s.count << ", \"avg\": " << s.avg << ", \"min\": " << s.min
+        << ", \"p50\": " << s.p50 << ", \"p95\": " << s.p95 << ", \"p99\": " << s.p99
+        << ", \"max\": " << s.max << "}";
+}
+
+static void writeSeriesJson(std::ostream& out, const std::vector<FrameStats::Series>& list) {
+    out << "{";
+    for (size_t i = 0; i < list.size(); ++i) {
+        out << (i ? ", " : "") << "\n    \"" << list[i].name << "\": ";
+        writeSummaryJson(out, summarize(list[i].values));
+    }
+    out << (list.empty() ? "}" : "\n  }");
+}
+
+bool FrameStats::writeJson(const std::string& path, const std::string& label) const {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+    out << std::fixed << std::setprecision(4);
+    out << "{\n";
+    out << "  \"label\": \"" << label << "\",\n";
+    out << "  \"frames\": " << frameCount() << ",\n";
+    out << "  \"frame_ms\": ";
+    writeSummaryJson(out, summarize(frameMs));
+    out << ",\n  \"cpu_ms\": ";
+    writeSummaryJson(out, summarize(cpuMs));
+    out << ",\n  \"gpu_ms\": ";
+    writeSummaryJson(out, summarize(gpuMs));
+    out << ",\n  \"gpu_passes_ms\": ";
+    writeSeriesJson(out, gpuPasses);
+    out << ",\n  \"counters\": ";
+    writeSeriesJson(out, counters);
+    out << ",\n  \"histogram\": {\"bucket_ms\": " << histogramBucketMs << ", \"counts\": [";
+    std::vector<size_t> counts = histogram();
+    for (size_t i = 0; i < counts.size(); ++i) out << (i ? ", " : "") << counts[i];
+    out << "]}\n}\n";
+    return true;
+}
@@ -0,0 +1,41 @@
+#include "game_systems.h"
+#include "components.h"
+
+Entity createPlayer(World& world, PhysicsWorld& physics, const Camera& camera) {
+    CharacterController controller;
+    controller.init(physics, camera.position);
+    glm::vec3 eye = controller.eyePosition();
+    return world.create(camera, Position{eye}, PreviousPosition{eye}, Velocity{}, Grounded{true},
+                        PlayerControl{}, controller);
+}
+
+void addTickSystems(SystemScheduler& scheduler, PhysicsWorld& physics) {
+    // update() moves the controller's Bullet body, so it writes the controller.
+    scheduler.add("CharacterMove", componentMask<PlayerControl>(), componentMask<CharacterController>(),
+                  [](World& world, float) {
+                      world.each<PlayerControl, CharacterController>(
+                          [](Entity, PlayerControl& control, CharacterController& controller) {
+                              controller.update(control.input);
+                          });
+                  });
+    scheduler.addExclusive("PhysicsStep", [&physics](World&, float dt) { physics.step(dt); });
+    scheduler.add("CharacterState", componentMask<CharacterController>(),
+                  componentMask<Position, PreviousPosition, Velocity, Grounded>(),
+                  [](World& world, float) {
+                      world.each<CharacterController, Position, PreviousPosition, Velocity, Grounded>(
+                          [](Entity, CharacterController& controller, Position& pos, PreviousPosition& prev,
+                             Velocity& vel, Grounded& grounded) {
+                              prev.value = pos.value;
+                              pos.value = controller.eyePosition();
+                              vel.value = controller.velocity();
+                              grounded.value = controller.onGround();
+                          });
+                  });
+}
+
+void syncRigidBodies(World& world, JobSystem& jobs, const PhysicsWorld& physics, Scene& scene) {
+    // Each row writes only its own scene object, so chunks can run in parallel.
+    world.parallelEach<PhysicsBody, SceneObject>(jobs, 1024, [&](Entity, PhysicsBody& body, SceneObject& object) {
+        scene.setTransform(object.index, physics.bodyModel(body.body));
+    });
+}
@@ -0,0 +1,138 @@
+#include "gl_state.h"
+
+static int bufferIndex(GLenum target) {
+    switch (target) {
+    case GL_ARRAY_BUFFER: return 0;
+    case GL_ELEMENT_ARRAY_BUFFER: return 1;
+    case GL_UNIFORM_BUFFER: return 2;
+    case GL_PIXEL_UNPACK_BUFFER: return 3;
+    case GL_PIXEL_PACK_BUFFER: return 4;
+    case GL_DRAW_INDIRECT_BUFFER: return 5;
+    case GL_COPY_READ_BUFFER: return 6;
+    case GL_COPY_WRITE_BUFFER: return 7;
+    default: return -1;
+    }
+}
+
+static int textureIndex(GLenum target) {
+    switch (target) {
+    case GL_TEXTURE_2D: return 0;
+    case GL_TEXTURE_2D_ARRAY: return 1;
+    case GL_TEXTURE_3D: return 2;
+    case GL_TEXTURE_CUBE_MAP: return 3;
+    default: return -1;
+    }
+}
+
+GlState& glState() {
+    static GlState state;
+    return state;
+}
+
+void GlState::reset() {
+    program = unknown;
+    vao = unknown;
+    activeUnit = unknown;
+    for (GLuint& b : buffers) b = unknown;
+    for (auto& unit : textures)
+        for (GLuint& t : unit) t = unknown;
+    for (Range& r : uniformRanges) r = {unknown, 0, 0};
+    capabilities.clear();
+    initialized = true;
+}
+
+bool GlState::track(GLuint& current, GLuint value) {
+    if (!initialized) reset();
+    if (current == value) {
+        ++skipped;
+        return false;
+    }
+    current = value;
+    ++issued;
+    return true;
+}
+
+void GlState::useProgram(GLuint p) {
+    if (track(program, p)) glUseProgram(p);
+}
+
+void GlState::bindVertexArray(GLuint v) {
+    if (!track(vao, v)) return;
+    glBindVertexArray(v);
+    buffers[bufferIndex(GL_ELEMENT_ARRAY_BUFFER)] = unknown;
+}
+
+void GlState::bindBuffer(GLenum target, GLuint buffer) {
+    int index = bufferIndex(target);
+    if (index < 0) {
+        ++issued;
+        glBindBuffer(target, buffer);
+        return;
+    }
+    if (track(buffers[index], buffer)) glBindBuffer(target, buffer);
+}
+
+void GlState::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    if (!initialized) reset();
+    if (target == GL_UNIFORM_BUFFER && index < GLuint(uniformBindings)) {
+        Range& r = uniformRanges[index];
+        if (r.buffer == buffer && r.offset == offset && r.size == size) {
+            ++skipped;
+            return;
+        }
+        r = {buffer, offset, size};
+    }
+    ++issued;
+    glBindBufferRange(target, index, buffer, offset, size);
+    // Also changes the generic binding point.
+    int generic = bufferIndex(target);
+    if (generic >= 0) buffers[generic] = buffer;
+}
+
+void GlState::bindTexture(GLuint unit, GLenum target, GLuint texture) {
+    int index = textureIndex(target);
+    if (unit < GLuint(textureUnits) && index >= 0) {
+        if (!track(textures[unit][index], texture)) return;
+    } else {
+        ++issued;
+    }
+    if (activeUnit != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        activeUnit = unit;
+        ++issued;
+    }
+    glBindTexture(target, texture);
+}
+
+void GlState::setEnabled(GLenum capability, bool enabled) {
+    auto it = capabilities.find(capability);
+    if (it != capabilities.end() && it->second == enabled) {
+        ++skipped;
+        return;
+    }
+    capabilities[capability] = enabled;
+    ++issued;
+    if (enabled) glEnable(capability);
+    else glDisable(capability);
+}
+
+void GlState::forgetProgram(GLuint p) {
+    if (program == p) program = unknown;
+}
+
+void GlState::forgetVertexArray(GLuint v) {
+    if (vao == v) vao = unknown;
+}
+
+void GlState::forgetBuffer(GLuint buffer) {
+    for (GLuint& b : buffers)
+        if (b == buffer) b = unknown;
+    for (Range& r : uniformRanges)
+        if (r.buffer == buffer) r = {unknown, 0, 0};
+}
+
+void GlState::forgetTexture(GLuint texture) {
+    for (auto& unit : textures)
+        for (GLuint& t : unit)
+            if (t == texture) t = unknown;
+}
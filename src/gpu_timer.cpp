@@ -0,0 +1,102 @@
+#include "gpu_timer.h"
+#include "profiler.h"
+
+void GpuTimer::init() {
+    for (Slot& slot : slots) glGenQueries(maxQueriesPerFrame, slot.queries);
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    cpuOffsetNs = int64_t(profilerNowNs()) - int64_t(gpuNow);
+    initialized = true;
+}
+
+void GpuTimer::shutdown() {
+    if (!initialized) return;
+    for (Slot& slot : slots) glDeleteQueries(maxQueriesPerFrame, slot.queries);
+    initialized = false;
+}
+
+int GpuTimer::issue(Slot& slot) {
+    if (slot.used == maxQueriesPerFrame) return -1;
+    glQueryCounter(slot.queries[slot.used], GL_TIMESTAMP);
+    return slot.used++;
+}
+
+void GpuTimer::beginFrame(size_t frame) {
+    Slot& slot = slots[frame % ringSize];
+    if (slot.pending) {
+        // The GPU is more than ringSize frames behind; reusing these queries
+        // would force a sync, so give up on that frame's numbers.
+        slot.pending = false;
+        ++droppedFrames;
+    }
+    slot.used = 0;
+    slot.frame = frame;
+    slot.passes.clear();
+    openPasses.clear();
+    current = &slot;
+    issue(slot);
+}
+
+void GpuTimer::beginPass(const char* name) {
+    if (!current) return;
+    int begin = issue(*current);
+    if (begin < 0) return;
+    current->passes.push_back({name, begin, -1});
+    openPasses.push_back(int(current->passes.size()) - 1);
+}
+
+void GpuTimer::endPass() {
+    if (!current || openPasses.empty()) return;
+    current->passes[openPasses.back()].endQuery = issue(*current);
+    openPasses.pop_back();
+}
+
+void GpuTimer::endFrame() {
+    if (!current) return;
+    while (!openPasses.empty()) endPass();
+    issue(*current);
+    current->pending = true;
+    current = nullptr;
+}
+
+bool GpuTimer::available(const Slot& slot) const {
+    for (int i = 0; i < slot.used; ++i) {
+        GLint ready = 0;
+        glGetQueryObjectiv(slot.queries[i], GL_QUERY_RESULT_AVAILABLE, &ready);
+        if (!ready) return false;
+    }
+    return true;
+}
+
+GpuFrameTimes GpuTimer::resolve(Slot& slot) {
+    GLuint64 stamps[maxQueriesPerFrame];
+    for (int i = 0; i < slot.used; ++i)
+        glGetQueryObjectui64v(slot.queries[i], GL_QUERY_RESULT, &stamps[i]);
+
+    GpuFrameTimes times;
+    times.frame = slot.frame;
+    times.totalMs = slot.used > 1 ? (stamps[slot.used - 1] - stamps[0]) / 1.0e6 : 0.0;
+    for (const Pass& pass : slot.passes) {
+        if (pass.endQuery < 0) continue;   // ran out of queries mid-frame
+        times.passes.push_back({pass.name, stamps[pass.beginQuery],
+                                (stamps[pass.endQuery] - stamps[pass.beginQuery]) / 1.0e6});
+    }
+    slot.pending = false;
+    return times;
+}
+
+std::vector<GpuFrameTimes> GpuTimer::collect(bool wait) {
+    // Oldest first, so callers see frames in submission order.
+    std::vector<Slot*> ready;
+    for (Slot& slot : slots)
+        if (slot.pending && (wait || available(slot))) ready.push_back(&slot);
+    std::vector<GpuFrameTimes> results;
+    while (!ready.empty()) {
+        size_t oldest = 0;
+        for (size_t i = 1; i < ready.size(); ++i)
+            if (ready[i]->frame < ready[oldest]->frame) oldest = i;
+        results.push_back(resolve(*ready[oldest]));
+        ready.erase(ready.begin() + oldest);
+    }
+    return results;
+}
@@ -0,0 +1,66 @@
+#include "indirect_draw.h"
+#include "gl_state.h"
+
+void IndirectDraws::init() {
+    if (GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect) {
+        submitMode = Mode::MultiDraw;
+        glGenBuffers(1, &buffer);
+    } else if (GLEW_VERSION_4_2 || GLEW_ARB_base_instance) {
+        submitMode = Mode::BaseInstance;
+    } else {
+        submitMode = Mode::Replay;
+    }
+}
+
+void IndirectDraws::destroy() {
+    if (buffer) {
+        glState().forgetBuffer(buffer);
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+    capacity = 0;
+    commands.clear();
+}
+
+void IndirectDraws::add(const MeshRange& mesh, GLuint firstInstance, GLuint instanceCount) {
+    if (!instanceCount) return;
+    commands.push_back({GLuint(mesh.indexCount), instanceCount, mesh.firstIndex, mesh.baseVertex, firstInstance});
+}
+
+void IndirectDraws::submit(MeshPool& pool) {
+    if (commands.empty()) return;
+    GlState& gl = glState();
+    pool.bind();
+    if (submitMode == Mode::MultiDraw) {
+        gl.bindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer);
+        if (commands.size() > capacity) capacity = commands.size() + commands.size() / 2;
+        // Orphaned every frame like the instance buffer.
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, GLsizeiptr(capacity * sizeof(DrawElementsIndirectCommand)), nullptr,
+                     GL_STREAM_DRAW);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, GLsizeiptr(commands.size() * sizeof(DrawElementsIndirectCommand)),
+                        commands.data());
+        glMultiDrawElementsIndirect(GL_TRIANGLES, pool.indexType, nullptr, GLsizei(commands.size()), 0);
+        return;
+    }
+    for (const DrawElementsIndirectCommand& c : commands) {
+        const void* offset = pool.indexOffset(c.firstIndex);
+        if (submitMode == Mode::BaseInstance) {
+            glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, GLsizei(c.count), pool.indexType, offset,
+                                                          GLsizei(c.instanceCount), c.baseVertex, c.baseInstance);
+        } else {
+            pool.setInstanceOffset(c.baseInstance);
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, GLsizei(c.count), pool.indexType, offset,
+                                              GLsizei(c.instanceCount), c.baseVertex);
+        }
+    }
+    if (submitMode == Mode::Replay) pool.setInstanceOffset(0);
+}
+
+const char* IndirectDraws::modeName() const {
+    switch (submitMode) {
+    case Mode::MultiDraw: return "multi-draw indirect";
+    case Mode::BaseInstance: return "base instance replay";
+    case Mode::Replay: return "attribute offset replay";
+    }
+    return "";
+}
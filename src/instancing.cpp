@@ -0,0 +1,139 @@
+#include "instancing.h"
+#include "gl_state.h"
+#include "shader.h"
+#include "uniform_ring.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+
+// Vertex shader bodies; vertexShaderSource() adds the pool's vertex decoder.
+static const char* instancedVsBody =
+    "layout(location = 4) in mat4 aModel;\n"
+    "layout(location = 8) in float aInstanceLayer;\n"
+    "out vec3 vColor;\n"
+    "out vec2 vTex;\n"
+    "flat out float vLayer;\n"
+    "layout(std140) uniform Frame { mat4 uViewProj; };\n"
+    "void main() {\n"
+    "    VertexData v = fetchVertex();\n"
+    "    vColor = v.color;\n"
+    "    vTex = v.uv;\n"
+    "    vLayer = v.layer + aInstanceLayer;\n"
+    "    gl_Position = uViewProj * aModel * vec4(v.position, 1.0);\n"
+    "}";
+
+static const char* perObjectVsBody =
+    "out vec3 vColor;\n"
+    "out vec2 vTex;\n"
+    "flat out float vLayer;\n"
+    "layout(std140) uniform Frame { mat4 uViewProj; };\n"
+    "layout(std140) uniform Object { mat4 uModel; float uLayer; };\n"
+    "void main() {\n"
+    "    VertexData v = fetchVertex();\n"
+    "    vColor = v.color;\n"
+    "    vTex = v.uv;\n"
+    "    vLayer = v.layer + uLayer;\n"
+    "    gl_Position = uViewProj * uModel * vec4(v.position, 1.0);\n"
+    "}";
+
+static const char* instanceFsSrc =
+    "#version 330 core\n"
+    "in vec3 vColor;\n"
+    "in vec2 vTex;\n"
+    "flat in float vLayer;\n"
+    "out vec4 FragColor;\n"
+    "uniform sampler2DArray uTex;\n"
+    "void main() {\n"
+    "    FragColor = texture(uTex, vec3(vTex, vLayer)) * vec4(vColor, 1.0);\n"
+    "}";
+
+bool createCubeMesh(MeshPool& pool, MeshRange& mesh) {
+    const glm::vec3 color{0.9f, 0.8f, 0.6f};
+    // Four corners per face, counter-clockwise seen from outside.
+    const glm::vec3 corners[24] = {
+        {-0.5f,-0.5f, 0.5f}, { 0.5f,-0.5f, 0.5f}, { 0.5f, 0.5f, 0.5f}, {-0.5f, 0.5f, 0.5f},
+        { 0.5f,-0.5f,-0.5f}, {-0.5f,-0.5f,-0.5f}, {-0.5f, 0.5f,-0.5f}, { 0.5f, 0.5f,-0.5f},
+        {-0.5f,-0.5f,-0.5f}, {-0.5f,-0.5f, 0.5f}, {-0.5f, 0.5f, 0.5f}, {-0.5f, 0.5f,-0.5f},
+        { 0.5f,-0.5f, 0.5f}, { 0.5f,-0.5f,-0.5f}, { 0.5f, 0.5f,-0.5f}, { 0.5f, 0.5f, 0.5f},
+        {-0.5f, 0.5f, 0.5f}, { 0.5f, 0.5f, 0.5f}, { 0.5f, 0.5f,-0.5f}, {-0.5f, 0.5f,-0.5f},
+        {-0.5f,-0.5f,-0.5f}, { 0.5f,-0.5f,-0.5f}, { 0.5f,-0.5f, 0.5f}, {-0.5f,-0.5f, 0.5f},
+    };
+    const glm::vec3 normals[6] = {{0.f, 0.f, 1.f}, {0.f, 0.f, -1.f}, {-1.f, 0.f, 0.f},
+                                  {1.f, 0.f, 0.f}, {0.f, 1.f, 0.f}, {0.f, -1.f, 0.f}};
+    const glm::vec2 uvs[4] = {{0.f, 0.f}, {1.f, 0.f}, {1.f, 1.f}, {0.f, 1.f}};
+    std::vector<Vertex> vertices(24);
+    for (int i = 0; i < 24; ++i) vertices[i] = {corners[i], color, uvs[i % 4], 0.0f, normals[i / 4]};
+    std::vector<uint32_t> indices(36);
+    for (unsigned face = 0; face < 6; ++face) {
+        const unsigned quad[6] = {0, 1, 2, 2, 3, 0};
+        for (int i = 0; i < 6; ++i) indices[face * 6 + i] = face * 4 + quad[i];
+    }
+    return pool.addOptimized("cube", std::move(vertices), std::move(indices), mesh);
+}
+
+bool createInstanceRenderer(InstanceRenderer& renderer, ShaderBatch& shaders, VertexFormat format) {
+    std::string instancedVs = vertexShaderSource(format, instancedVsBody);
+    std::string perObjectVs = vertexShaderSource(format, perObjectVsBody);
+    // Untextured stand-ins go into the batch ahead of the real programs.
+    size_t instancedFallback = shaders.add(instancedVs.c_str(), fallbackFsSrc);
+    size_t perObjectFallback = shaders.add(perObjectVs.c_str(), fallbackFsSrc);
+    renderer.shaders = &shaders;
+    renderer.instancedShader = shaders.add(instancedVs.c_str(), instanceFsSrc, instancedFallback);
+    renderer.perObjectShader = shaders.add(perObjectVs.c_str(), instanceFsSrc, perObjectFallback);
+    return true;
+}
+
+void destroyInstanceRenderer(InstanceRenderer& renderer) {
+    // The programs belong to the ShaderBatch.
+    renderer = InstanceRenderer{};
+}
+
+void drawInstances(InstanceRenderer& renderer, MeshPool& pool, const MeshRange& mesh,
+                   const std::vector<InstanceData>& instances, UniformRing& uniforms, bool perObject) {
+    GlState& gl = glState();
+    if (!perObject) {
+        GLuint program = renderer.shaders->program(renderer.instancedShader);
+        if (!program) return;   // nothing compiled yet
+        gl.useProgram(program);
+        pool.drawInstanced(mesh, GLsizei(instances.size()));
+        return;
+    }
+    // Every object's block is written in one linear pass before the first
+    // draw; each draw then only moves the Object binding. The per-object
+    // program declares no instance attributes, so the pool's per-instance
+    // arrays are ignored here.
+    GLuint program = renderer.shaders->program(renderer.perObjectShader);
+    if (!program) return;
+    renderer.objectOffsets.resize(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i)
+        renderer.objectOffsets[i] = uniforms.allocate(&instances[i], sizeof(InstanceData));
+    uniforms.upload();
+    gl.useProgram(program);
+    for (GLintptr offset : renderer.objectOffsets) {
+        if (offset < 0) break;   // ring full, see UniformRing::overflows
+        gl.bindBufferRange(GL_UNIFORM_BUFFER, objectUniformBinding, uniforms.buffer, offset, sizeof(InstanceData));
+        pool.draw(mesh);
+    }
+}
+
+void drawIndirect(InstanceRenderer& renderer, MeshPool& pool, IndirectDraws& draws) {
+    GLuint program = renderer.shaders->program(renderer.instancedShader);
+    if (!program) return;
+    glState().useProgram(program);
+    draws.submit(pool);
+}
+
+std::vector<InstanceData> makeCrateScene(size_t count, size_t layerCount) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> x(-9.5f, 9.5f), y(0.2f, 4.8f), z(-9.5f, 9.5f);
+    std::uniform_real_distribution<float> size(0.05f, 0.3f), angle(0.0f, 360.0f);
+    std::uniform_int_distribution<size_t> layer(0, layerCount ? layerCount - 1 : 0);
+    std::vector<InstanceData> instances(count);
+    for (InstanceData& inst : instances) {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), {x(rng), y(rng), z(rng)});
+        model = glm::rotate(model, glm::radians(angle(rng)), {0.0f, 1.0f, 0.0f});
+        inst.model = glm::scale(model, glm::vec3(size(rng)));
+        inst.layer = float(layer(rng));
+        inst.pad[0] = inst.pad[1] = inst.pad[2] = 0.0f;
+    }
+    return instances;
+}
@@ -0,0 +1,224 @@
+#include "job_system.h"
+#include "profiler.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+namespace {
+
+// Which JobSystem owns the current thread, and its queue index there.
+thread_local const JobSystem* t_owner = nullptr;
+thread_local int t_index = -1;
+
+} // namespace
+
+size_t TaskGraph::add(std::function<void()> fn) {
+    nodes.emplace_back();
+    nodes.back().fn = std::move(fn);
+    return nodes.size() - 1;
+}
+
+void TaskGraph::precede(size_t before, size_t after) {
+    nodes[before].successors.push_back(after);
+    ++nodes[after].predecessors;
+}
+
+void JobSystem::init(unsigned threadCount) {
+    if (threadCount == 0) threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0) threadCount = 1;
+    stopping = false;
+    for (unsigned i = 0; i < threadCount; ++i) queues.push_back(std::make_unique<Queue>());
+    t_owner = this;
+    t_index = 0;
+    for (unsigned i = 1; i < threadCount; ++i) threads.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+void JobSystem::shutdown() {
+    if (queues.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : threads) t.join();
+    threads.clear();
+    // Whatever is still queued runs here so counters are never left pending.
+    Job job;
+    while (findJob(localIndex(), true, job)) execute(job);
+    queues.clear();
+    if (t_owner == this) {
+        t_owner = nullptr;
+        t_index = -1;
+    }
+}
+
+int JobSystem::localIndex() const {
+    return t_owner == this ? t_index : -1;
+}
+
+void JobSystem::push(Queue& queue, Job job) {
+    if (job.counter) job.counter->pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+    queued.fetch_add(1);
+    if (!threads.empty()) {
+        // Taking the lock orders the push before a worker's predicate check,
+        // so a worker about to sleep cannot miss it.
+        { std::lock_guard<std::mutex> lock(sleepMutex); }
+        wake.notify_one();
+    }
+}
+
+void JobSystem::submit(std::function<void()> fn, JobCounter* counter) {
+    // Threads outside the pool hand their jobs to the main thread's queue,
+    // where workers steal them.
+    int index = localIndex();
+    push(*queues[index < 0 ? 0 : size_t(index)], {std::move(fn), counter});
+}
+
+void JobSystem::submitBackground(std::function<void()> fn, JobCounter* counter) {
+    push(background, {std::move(fn), counter});
+}
+
+bool JobSystem::popLocal(int index, Job& job) {
+    if (index < 0) return false;
+    Queue& q = *queues[size_t(index)];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.jobs.empty()) return false;
+    job = std::move(q.jobs.back());
+    q.jobs.pop_back();
+    queued.fetch_sub(1);
+    return true;
+}
+
+bool JobSystem::steal(int thief, Job& job) {
+    size_t n = queues.size();
+    size_t start = thief < 0 ? 0 : size_t(thief) + 1;
+    for (size_t k = 0; k < n; ++k) {
+        size_t victim = (start + k) % n;
+        if (int(victim) == thief) continue;
+        Queue& q = *queues[victim];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.jobs.empty()) continue;
+        job = std::move(q.jobs.front());
+        q.jobs.pop_front();
+        queued.fetch_sub(1);
+        stolenJobs.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool JobSystem::popBackground(Job& job) {
+    std::lock_guard<std::mutex> lock(background.mutex);
+    if (background.jobs.empty()) return false;
+    job = std::move(background.jobs.front());
+    background.jobs.pop_front();
+    queued.fetch_sub(1);
+    return true;
+}
+
+bool JobSystem::findJob(int index, bool includeBackground, Job& job) {
+    return popLocal(index, job) || steal(index, job) || (includeBackground && popBackground(job));
+}
+
+void JobSystem::execute(Job& job) {
+    job.fn();
+    executedJobs.fetch_add(1, std::memory_order_relaxed);
+    if (job.counter) job.counter->pending.fetch_sub(1, std::memory_order_release);
+    job = Job{};
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    PROFILE_ZONE("WaitJobs");
+    int index = localIndex();
+    while (!counter.done()) {
+        Job job;
+        if (findJob(index, threads.empty(), job)) execute(job);
+        else std::this_thread::yield();
+    }
+}
+
+size_t JobSystem::runBackground(size_t maxJobs) {
+    if (!threads.empty()) return 0;
+    size_t count = 0;
+    Job job;
+    while (count < maxJobs && popBackground(job)) {
+        execute(job);
+        ++count;
+    }
+    return count;
+}
+
+void JobSystem::workerLoop(unsigned index) {
+    t_owner = this;
+    t_index = int(index);
+    std::string name = "job worker " + std::to_string(index);
+    profilerSetThreadName(name.c_str());
+    while (!stopping.load()) {
+        Job job;
+        if (findJob(int(index), true, job)) {
+            execute(job);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return stopping.load() || queued.load() > 0; });
+    }
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+    if (count <= grain || queues.size() < 2) {
+        body(0, count);
+        return;
+    }
+    JobCounter counter;
+    for (size_t begin = grain; begin < count; begin += grain) {
+        size_t end = std::min(count, begin + grain);
+        submit([&body, begin, end] { body(begin, end); }, &counter);
+    }
+    body(0, grain);
+    wait(counter);
+}
+
+void JobSystem::runNode(TaskGraph& graph, size_t node, JobCounter& counter) {
+    graph.nodes[node].fn();
+    for (size_t next : graph.nodes[node].successors) {
+        if (graph.nodes[next].remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            submit([this, &graph, next, &counter] { runNode(graph, next, counter); }, &counter);
+    }
+}
+
+bool JobSystem::run(TaskGraph& graph) {
+    // Kahn's algorithm over a copy of the counts rejects cycles, which would
+    // otherwise leave wait() spinning forever.
+    std::vector<size_t> indegree(graph.size());
+    std::vector<size_t> ready;
+    for (size_t i = 0; i < graph.size(); ++i) {
+        indegree[i] = graph.nodes[i].predecessors;
+        if (indegree[i] == 0) ready.push_back(i);
+    }
+    std::vector<size_t> roots = ready;
+    size_t visited = 0;
+    while (!ready.empty()) {
+        size_t i = ready.back();
+        ready.pop_back();
+        ++visited;
+        for (size_t next : graph.nodes[i].successors)
+            if (--indegree[next] == 0) ready.push_back(next);
+    }
+    if (visited != graph.size()) {
+        std::cerr << "Task graph has a dependency cycle" << std::endl;
+        return false;
+    }
+
+    for (TaskGraph::Node& node : graph.nodes) node.remaining.store(node.predecessors, std::memory_order_relaxed);
+    JobCounter counter;
+    for (size_t root : roots)
+        submit([this, &graph, root, &counter] { runNode(graph, root, counter); }, &counter);
+    wait(counter);
+    return true;
+}
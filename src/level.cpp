@@ -0,0 +1,66 @@
+#include "level.h"
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+
+bool Level::open(const std::string& path) {
+    *this = Level{};
+    if (!file.open(path)) return false;
+    return open(file.data(), file.size(), path);
+}
+
+bool Level::open(const unsigned char* base, size_t size, const std::string& name) {
+    auto fail = [&](const char* why) {
+        std::cerr << "Invalid level " << name << ": " << why << std::endl;
+        *this = Level{};
+        return false;
+    };
+    if (reinterpret_cast<uintptr_t>(base) % alignof(LevelHeader) != 0) return fail("misaligned data");
+    if (size < sizeof(LevelHeader)) return fail("truncated header");
+    const LevelHeader* header = reinterpret_cast<const LevelHeader*>(base);
+    if (header->magic != levelMagic) return fail("bad magic");
+    if (header->version != levelVersion) return fail("unsupported version");
+
+    // The only fixup: section offsets become typed pointers into the mapping.
+    bool inRange = true;
+    auto resolve = [&](const LevelSection& section, auto& span) {
+        using T = std::remove_reference_t<decltype(*span.data)>;
+        if (section.offset % alignof(T) != 0 || section.offset > size ||
+            section.count > (size - section.offset) / sizeof(T)) {
+            inRange = false;
+            return;
+        }
+        span.data = reinterpret_cast<const T*>(base + section.offset);
+        span.count = size_t(section.count);
+    };
+    resolve(header->materials, materials);
+    resolve(header->meshes, meshes);
+    resolve(header->vertices, vertices);
+    resolve(header->indices, indices);
+    resolve(header->entities, entities);
+    resolve(header->colliders, colliders);
+    if (!inRange) return fail("section out of range");
+
+    // Validate once here so callers can trust every reference.
+    if (materials.size() > levelMaxMaterials) return fail("too many materials");
+    for (const LevelMaterial& m : materials)
+        if (std::memchr(m.texture, 0, levelTextureNameLength) == nullptr) return fail("unterminated texture name");
+    for (const LevelMesh& m : meshes) {
+        if (std::memchr(m.name, 0, levelNameLength) == nullptr) return fail("unterminated mesh name");
+        if (m.material >= materials.size()) return fail("mesh material out of range");
+        if (m.firstVertex > vertices.size() || m.vertexCount > vertices.size() - m.firstVertex ||
+            m.firstIndex > indices.size() || m.indexCount > indices.size() - m.firstIndex || m.indexCount % 3)
+            return fail("mesh range out of range");
+        for (uint32_t i = 0; i < m.indexCount; ++i)
+            if (indices[m.firstIndex + i] >= m.vertexCount) return fail("index out of range");
+    }
+    for (const Vertex& v : vertices)
+        if (!(v.layer >= 1.0f && v.layer <= float(materials.size())) || v.layer != float(uint32_t(v.layer)))
+            return fail("vertex material out of range");
+    for (const LevelEntity& e : entities) {
+        if (e.kind != LevelPlayerStart && e.kind != LevelStaticMesh) return fail("unknown entity kind");
+        if (e.kind == LevelStaticMesh && e.mesh >= meshes.size()) return fail("entity mesh out of range");
+    }
+    return true;
+}
@@ -3,81 +3,41 @@
 #include <SDL_opengl.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include <cmath>
 #include <filesystem>
 #include <random>
 #include "stb_image.h"
-
-struct Camera {
-    glm::vec3 position{0.0f, 1.0f, 0.0f};
-    float pitch = 0.0f;
-    float yaw = -90.0f;
-
-    glm::mat4 getViewMatrix() const {
-        glm::vec3 front{
-            cos(glm::radians(yaw)) * cos(glm::radians(pitch)),
-            sin(glm::radians(pitch)),
-            sin(glm::radians(yaw)) * cos(glm::radians(pitch))
-        };
-        return glm::lookAt(position, position + glm::normalize(front), {0.0f, 1.0f, 0.0f});
-    }
-};
-
-GLuint compileShader(GLenum type, const char* src) {
-    GLuint shader = glCreateShader(type);
-    glShaderSource(shader, 1, &src, nullptr);
-    glCompileShader(shader);
-    GLint success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char log[512];
-        glGetShaderInfoLog(shader, 512, nullptr, log);
-        std::cerr << "Shader compile error: " << log << std::endl;
-    }
-    return shader;
-}
-
-GLuint createProgram(const char* vsSrc, const char* fsSrc) {
-    GLuint vs = compileShader(GL_VERTEX_SHADER, vsSrc);
-    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fsSrc);
-    GLuint prog = glCreateProgram();
-    glAttachShader(prog, vs);
-    glAttachShader(prog, fs);
-    glLinkProgram(prog);
-    GLint success;
-    glGetProgramiv(prog, GL_LINK_STATUS, &success);
-    if (!success) {
-        char log[512];
-        glGetProgramInfoLog(prog, 512, nullptr, log);
-        std::cerr << "Program link error: " << log << std::endl;
-    }
-    glDeleteShader(vs);
-    glDeleteShader(fs);
-    return prog;
-}
-
-GLuint loadTexture(const std::string& path) {
-    int w, h, channels;
-    stbi_uc* data = stbi_load(path.c_str(), &w, &h, &channels, STBI_rgb_alpha);
-    if (!data) {
-        std::cerr << "Failed to load " << path << std::endl;
-        return 0;
-    }
-    GLuint tex;
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    stbi_image_free(data);
-    return tex;
-}
+#include "camera.h"
+#include "components.h"
+#include "ecs.h"
+#include "flythrough.h"
+#include "frame_stats.h"
+#include "gl_state.h"
+#include "game_systems.h"
+#include "gpu_timer.h"
+#include "indirect_draw.h"
+#include "instancing.h"
+#include "job_system.h"
+#include "level.h"
+#include "mesh_pool.h"
+#include "model_loader.h"
+#include "offscreen.h"
+#include "options.h"
+#include "pak.h"
+#include "physics.h"
+#include "player.h"
+#include "profiler.h"
+#include "scene.h"
+#include "shader.h"
+#include "shader_cache.h"
+#include "texture_container.h"
+#include "texture_loader.h"
+#include "texture_manager.h"
+#include "timer.h"
+#include "uniform_ring.h"
 
 std::filesystem::path findImagesDir(const char* exePath) {
     namespace fs = std::filesystem;
@@ -94,24 +54,104 @@ std::filesystem::path findImagesDir(const char* exePath) {
     return "images"; // fallback
 }
 
-std::vector<GLuint> loadNoTextureVariants(const std::filesystem::path& dir) {
+// The asset pak is built next to the executable. Everything in it is found
+// through its table of contents; the loose-file lookups below are only used
+// when there is no pak or it lacks an entry.
+std::filesystem::path findPak(const char* exePath) {
+    namespace fs = std::filesystem;
+    fs::path file{"data.pak"};
+    if (fs::exists(file)) return file;
+
+    file = fs::absolute(exePath).parent_path() / "data.pak";
+    if (fs::exists(file)) return file;
+
+    return {};
+}
+
+// Cooked textures are produced by the build next to the executable.
+std::filesystem::path findCookedTextures(const char* exePath) {
     namespace fs = std::filesystem;
-    std::vector<GLuint> textures;
+    fs::path file{"textures.ftc"};
+    if (fs::exists(file)) return file;
+
+    file = fs::absolute(exePath).parent_path() / "textures.ftc";
+    if (fs::exists(file)) return file;
+
+    return {};
+}
+
+// Levels are converted from levels/*.level by the build, next to the
+// executable.
+std::filesystem::path findLevel(const char* exePath) {
+    namespace fs = std::filesystem;
+    fs::path file{"room.lvl"};
+    if (fs::exists(file)) return file;
+
+    file = fs::absolute(exePath).parent_path() / "room.lvl";
+    if (fs::exists(file)) return file;
+
+    return {};
+}
+
+// Drops count boxes of a few sizes in a jittered grid filling the room from
+// the ceiling down, each an entity linking its body to a new scene object.
+void spawnRigidBodies(World& world, PhysicsWorld& physics, Scene& scene, size_t count, size_t layerCount) {
+    std::mt19937 rng(4321);
+    std::uniform_real_distribution<float> jitter(-0.05f, 0.05f);
+    std::uniform_int_distribution<int> sizeClass(0, 2);
+    std::uniform_int_distribution<size_t> layer(0, layerCount ? layerCount - 1 : 0);
+    const float spacing = 0.6f;
+    const int perRow = int(19.0f / spacing);
+    // Layers from the ceiling down to just above the floor; the largest box
+    // has half extent 0.2, so the lowest centre stays at 0.3 or above.
+    const int levels = int((4.6f - 0.3f) / spacing) + 1;
+    const size_t capacity = size_t(perRow) * size_t(perRow) * size_t(levels);
+    if (count > capacity) {
+        std::cerr << "Room holds " << capacity << " rigid bodies, spawning that many instead of " << count
+                  << std::endl;
+        count = capacity;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        int col = int(i % size_t(perRow));
+        int row = int(i / size_t(perRow)) % perRow;
+        int level = int(i / size_t(perRow * perRow));
+        glm::vec3 center{-9.5f + spacing * (col + 0.5f) + jitter(rng),
+                         4.6f - level * spacing,
+                         -9.5f + spacing * (row + 0.5f) + jitter(rng)};
+        float half = 0.1f + 0.05f * float(sizeClass(rng));
+        size_t body = physics.addDynamicBox(center, glm::vec3(half), 8.0f * half * half * half * 500.0f);
+        InstanceData inst;
+        inst.model = physics.bodyModel(body);
+        inst.layer = float(layer(rng));
+        inst.pad[0] = inst.pad[1] = inst.pad[2] = 0.0f;
+        // A cube of edge 2*half reaches sqrt(3)*half from its centre.
+        size_t object = scene.add(inst, center, 1.7320508f * half);
+        world.create(PhysicsBody{body}, SceneObject{object});
+    }
+}
+
+std::vector<std::string> findNoTextureVariants(const std::filesystem::path& dir) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> files;
     if (!fs::exists(dir)) {
         std::cerr << "Images directory not found: " << dir << std::endl;
-        return textures;
+        return files;
     }
     for (auto& p : fs::directory_iterator(dir)) {
         std::string fname = p.path().filename().string();
         if (fname.rfind("no_texture", 0) == 0 && p.path().extension() == ".png") {
-            GLuint tex = loadTexture(p.path().string());
-            if (tex) textures.push_back(tex);
+            files.push_back(p.path().string());
         }
     }
-    return textures;
+    // directory_iterator order is unspecified; keep texture indices stable.
+    std::sort(files.begin(), files.end());
+    return files;
 }
 
-bool initSDL(SDL_Window** window, SDL_GLContext* context, int width, int height) {
+bool initSDL(SDL_Window** window, SDL_GLContext* context, int width, int height, bool headless) {
+    // Build farm machines have no display; SDL's offscreen driver gives us an
+    // EGL context (llvmpipe when there is no GPU). SDL_VIDEODRIVER still wins.
+    if (headless && !SDL_getenv("SDL_VIDEODRIVER")) SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS) != 0) {
         std::cerr << "SDL_Init Error: " << SDL_GetError() << std::endl;
         return false;
@@ -120,7 +160,8 @@ bool initSDL(SDL_Window** window, SDL_GLContext* context, int width, int height)
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
 
-    *window = SDL_CreateWindow("FPS", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN);
+    Uint32 flags = SDL_WINDOW_OPENGL | (headless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN);
+    *window = SDL_CreateWindow("FPS", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, flags);
     if (!*window) {
         std::cerr << "SDL_CreateWindow Error: " << SDL_GetError() << std::endl;
         return false;
@@ -132,57 +173,25 @@ bool initSDL(SDL_Window** window, SDL_GLContext* context, int width, int height)
         return false;
     }
 
-    SDL_SetRelativeMouseMode(SDL_TRUE);
+    if (!headless) SDL_SetRelativeMouseMode(SDL_TRUE);
 
     return true;
 }
 
-void processInput(Camera& cam, float deltaTime, float& velY, bool& onGround,
-                  const Uint8* keystate, int dx, int dy) {
-    const float sensitivity = 0.1f;
-    const float speed = 5.0f;
-    const float gravity = 9.8f;
-    const float jumpSpeed = 5.0f;
-
-    cam.yaw += dx * sensitivity;
-    cam.pitch -= dy * sensitivity;
-    if (cam.pitch > 89.0f) cam.pitch = 89.0f;
-    if (cam.pitch < -89.0f) cam.pitch = -89.0f;
-
-    glm::vec3 front{
-        cos(glm::radians(cam.yaw)) * cos(glm::radians(cam.pitch)),
-        0.0f,
-        sin(glm::radians(cam.yaw)) * cos(glm::radians(cam.pitch))
-    };
-    front = glm::normalize(front);
-    glm::vec3 right = glm::normalize(glm::cross(front, glm::vec3{0.0f, 1.0f, 0.0f}));
-
-    glm::vec3 move(0.0f);
-    if (keystate[SDL_SCANCODE_W]) move += front;
-    if (keystate[SDL_SCANCODE_S]) move -= front;
-    if (keystate[SDL_SCANCODE_A]) move -= right;
-    if (keystate[SDL_SCANCODE_D]) move += right;
-    if (glm::length(move) > 0.0f) cam.position += glm::normalize(move) * speed * deltaTime;
-
-    if (keystate[SDL_SCANCODE_SPACE] && onGround) {
-        velY = jumpSpeed;
-        onGround = false;
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parseOptions(argc, argv, opts)) {
+        printUsage(argv[0]);
+        return -1;
     }
-
-    velY -= gravity * deltaTime;
-    cam.position.y += velY * deltaTime;
-    if (cam.position.y < 1.0f) {
-        cam.position.y = 1.0f;
-        velY = 0.0f;
-        onGround = true;
+    if (!opts.tracePath.empty()) {
+        profilerSetThreadName("main");
+        profilerSetEnabled(true);
     }
-}
-
-int main(int argc, char** argv) {
-    const int width = 800, height = 600;
+    const int width = opts.width, height = opts.height;
     SDL_Window* window = nullptr;
     SDL_GLContext context;
-    if (!initSDL(&window, &context, width, height)) return -1;
+    if (!initSDL(&window, &context, width, height, opts.headless)) return -1;
 
     glewExperimental = GL_TRUE;
     GLenum glewStatus = glewInit();
@@ -191,153 +200,530 @@ int main(int argc, char** argv) {
         return -1;
     }
 
+    OffscreenTarget offscreen;
+    if (opts.headless) {
+        std::cout << "Headless renderer: " << glGetString(GL_RENDERER) << std::endl;
+        if (!createOffscreenTarget(offscreen, width, height)) return -1;
+    }
+
     glViewport(0, 0, width, height);
-    glEnable(GL_DEPTH_TEST);
+    GlState& gl = glState();
+    gl.setEnabled(GL_DEPTH_TEST, true);
 
-    const char* vsSrc =
-        "#version 330 core\n"
-        "layout(location = 0) in vec3 aPos;\n"
-        "layout(location = 1) in vec3 aColor;\n"
-        "layout(location = 2) in vec2 aTex;\n"
+    // Benchmarks measure render cost, not the display's refresh rate.
+    bool benchmark = !opts.benchmarkPath.empty();
+    if (benchmark) SDL_GL_SetSwapInterval(0);
+    Flythrough flythrough = Flythrough::defaultPath();
+
+    VertexFormat vertexFormat;
+    if (!parseVertexFormat(opts.vertexFormat, vertexFormat)) {
+        std::cerr << "Unknown vertex format: " << opts.vertexFormat << std::endl;
+        return -1;
+    }
+    std::string vsSrc = vertexShaderSource(vertexFormat,
         "out vec3 vColor;\n"
         "out vec2 vTex;\n"
-        "uniform mat4 uMVP;\n"
+        "flat out float vLayer;\n"
+        "layout(std140) uniform Frame { mat4 uViewProj; };\n"
+        "layout(std140) uniform Object { mat4 uModel; float uLayer; };\n"
         "void main() {\n"
-        "    vColor = aColor;\n"
-        "    vTex = aTex;\n"
-        "    gl_Position = uMVP * vec4(aPos, 1.0);\n"
-        "}";
+        "    VertexData v = fetchVertex();\n"
+        "    vColor = v.color;\n"
+        "    vTex = v.uv;\n"
+        "    vLayer = v.layer + uLayer;\n"
+        "    gl_Position = uViewProj * uModel * vec4(v.position, 1.0);\n"
+        "}");
 
     const char* fsSrc =
         "#version 330 core\n"
         "in vec3 vColor;\n"
         "in vec2 vTex;\n"
+        "flat in float vLayer;\n"
         "out vec4 FragColor;\n"
-        "uniform sampler2D uTex;\n"
+        "uniform sampler2DArray uTex;\n"
         "void main() {\n"
-        "    FragColor = texture(uTex, vTex) * vec4(vColor, 1.0);\n"
+        "    FragColor = texture(uTex, vec3(vTex, vLayer)) * vec4(vColor, 1.0);\n"
         "}";
 
-    GLuint program = createProgram(vsSrc, fsSrc);
-    glUseProgram(program);
-    glUniform1i(glGetUniformLocation(program, "uTex"), 0);
-
-    std::filesystem::path imageDir = findImagesDir(argv[0]);
-    std::vector<GLuint> noTextures = loadNoTextureVariants(imageDir);
-    if (noTextures.empty()) {
+    // Linked programs are cached on disk; later launches skip compilation.
+    ProgramCache programCache;
+    if (!opts.noShaderCache) {
+        std::string cacheDir = opts.shaderCacheDir;
+        if (cacheDir.empty()) {
+            if (char* pref = SDL_GetPrefPath("fps", "fps")) {
+                cacheDir = std::string(pref) + "shaders";
+                SDL_free(pref);
+            }
+        }
+        programCache.init(cacheDir);
+    }
+    // Every program is compiled in one batch that finishes in the background
+    // while textures load; untextured stand-ins come first in the batch and
+    // draw until the real programs are ready.
+    Uint64 shaderStart = SDL_GetPerformanceCounter();
+    bool shadersReported = false;
+    ShaderBatch shaders;
+    shaders.bindUniformBlock("Frame", frameUniformBinding);
+    shaders.bindUniformBlock("Object", objectUniformBinding);
+    shaders.bindUniformBlock("Meshes", meshUniformBinding);
+    shaders.bindUniformBlock("Materials", materialUniformBinding);
+    size_t roomFallback = shaders.add(vsSrc.c_str(), fallbackFsSrc);
+    size_t roomShader = shaders.add(vsSrc.c_str(), fsSrc, roomFallback);
+    InstanceRenderer instanceRenderer;
+    bool drawInstancesEnabled = opts.crates > 0 || opts.rigidBodies > 0;
+    if ((drawInstancesEnabled || opts.multiDrawIndirect) && !createInstanceRenderer(instanceRenderer, shaders, vertexFormat))
+        return -1;
+    shaders.submit(&programCache);
+
+    // All placeholder variants live in the layers of one texture array so
+    // surfaces with different textures can share a draw call. Prefer the
+    // cooked container: its levels upload straight from the mapping.
+    // Otherwise decode the PNGs, streaming them in behind grey layers.
+    JobSystem jobs;
+    jobs.init(unsigned(opts.threads));
+
+    // Declared before the streamer, whose decode jobs may read from it.
+    PakArchive pak;
+    std::filesystem::path pakPath = findPak(argv[0]);
+    if (!pakPath.empty() && pak.open(pakPath.string()))
+        std::cout << "Opened " << pakPath.string() << " (" << pak.size() << " entries)" << std::endl;
+
+    Uint64 textureStart = SDL_GetPerformanceCounter();
+    bool texturesReported = false;
+    TextureManager textures;
+    textures.setBudget(size_t(opts.textureBudgetMb * 1024.0 * 1024.0));
+    TextureStreamer textureStreamer;
+    TextureManager::Handle textureArray = TextureManager::invalid;
+    std::vector<std::string> textureNames;       // for resolving level materials
+    std::vector<uint32_t> textureNameLayers;     // layer of each name; identical images share one
+    TextureContainer cookedTextures;
+    std::vector<unsigned char> cookedScratch;   // backs cookedTextures if its entry is compressed
+    const PakEntry* cookedEntry = pak.find("textures.ftc");
+    const unsigned char* cookedData = cookedEntry ? pak.bytes(*cookedEntry, cookedScratch) : nullptr;
+    std::filesystem::path cookedPath = cookedData ? std::filesystem::path() : findCookedTextures(argv[0]);
+    if ((cookedData && cookedTextures.open(cookedData, size_t(cookedEntry->size), "textures.ftc")) ||
+        (!cookedPath.empty() && cookedTextures.open(cookedPath.string()))) {
+        textureArray = uploadCookedArray(textures, cookedTextures, "no_texture", textureNames, textureNameLayers);
+        std::cout << "Loaded " << textureNames.size() << " cooked textures in "
+                  << elapsedMs(textureStart, SDL_GetPerformanceCounter()) << " ms" << std::endl;
+        textures.printReport(std::cout);
+        texturesReported = true;
+    } else {
+        // Pak entries are sorted by name, so a prefix lookup replaces
+        // scanning and sorting the images directory.
+        std::vector<std::string> textureFiles;
+        for (const PakEntry* entry : pak.list("images/no_texture")) {
+            std::string_view name = pak.name(*entry);
+            if (name.size() > 4 && name.substr(name.size() - 4) == ".png") textureFiles.emplace_back(name);
+        }
+        const PakArchive* textureSource = &pak;
+        if (textureFiles.empty()) {
+            textureFiles = findNoTextureVariants(findImagesDir(argv[0]));
+            textureSource = nullptr;
+        }
+        if (!textureFiles.empty() && textureStreamer.start(textureFiles, jobs, textureSource)) {
+            // Layers are allocated before anything is decoded, so streamed
+            // images are not shared by content; the manager still tracks the
+            // array's memory and can evict its mips once streaming is done.
+            uint32_t levels = 1;
+            while ((std::max(textureStreamer.width, textureStreamer.height) >> levels) > 0) ++levels;
+            textureArray = textures.add("no_texture*", textureStreamer.array, GL_TEXTURE_2D_ARRAY, 0,
+                                        uint32_t(textureStreamer.width), uint32_t(textureStreamer.height),
+                                        uint32_t(textureFiles.size()), levels);
+            for (const std::string& file : textureFiles) {
+                textureNameLayers.push_back(uint32_t(textureNames.size()));
+                textureNames.push_back(std::filesystem::path(file).stem().string());
+            }
+        }
+    }
+    if (!textureArray) {
         std::cerr << "No placeholder textures found" << std::endl;
         return -1;
     }
+    const size_t textureLayers = *std::max_element(textureNameLayers.begin(), textureNameLayers.end()) + 1;
+
+    // The level is used straight from its mapping (or the pak's); meshes
+    // upload from it.
+    Level level;
+    std::vector<unsigned char> levelScratch;   // backs level if its pak entry is compressed
+    {
+        PROFILE_ZONE("LoadLevel");
+        Uint64 levelStart = SDL_GetPerformanceCounter();
+        std::filesystem::path levelPath = opts.levelPath;
+        const PakEntry* levelEntry = levelPath.empty() ? pak.find("room.lvl") : nullptr;
+        const unsigned char* levelData = levelEntry ? pak.bytes(*levelEntry, levelScratch) : nullptr;
+        bool loaded = false;
+        if (levelData) {
+            levelPath = pakPath / "room.lvl";
+            loaded = level.open(levelData, size_t(levelEntry->size), levelPath.string());
+        } else {
+            if (levelPath.empty()) levelPath = findLevel(argv[0]);
+            loaded = !levelPath.empty() && level.open(levelPath.string());
+        }
+        if (!loaded) {
+            std::cerr << "No level found" << std::endl;
+            return -1;
+        }
+        std::cout << "Loaded level " << levelPath.string() << " (" << level.meshes.size() << " meshes, "
+                  << level.vertices.size() << " vertices, " << level.entities.size() << " entities) in "
+                  << elapsedMs(levelStart, SDL_GetPerformanceCounter()) << " ms" << std::endl;
+    }
 
-    std::mt19937 rng(SDL_GetTicks());
-    std::uniform_int_distribution<size_t> dist(0, noTextures.size() - 1);
-    GLuint faceTex[6];
-    for (int i = 0; i < 6; ++i) faceTex[i] = noTextures[dist(rng)];
-
-    float vertices[] = {
-        // pos                 // color          // tex
-        -10.f,0.f,-10.f, 0.7f,0.7f,0.7f, 0.f,0.f,
-         10.f,0.f,-10.f, 0.7f,0.7f,0.7f, 1.f,0.f,
-         10.f,5.f,-10.f, 0.7f,0.7f,0.7f, 1.f,1.f,
-        -10.f,5.f,-10.f, 0.7f,0.7f,0.7f, 0.f,1.f,
-
-        -10.f,0.f,10.f, 0.7f,0.7f,0.7f, 0.f,0.f,
-         10.f,0.f,10.f, 0.7f,0.7f,0.7f, 1.f,0.f,
-         10.f,5.f,10.f, 0.7f,0.7f,0.7f, 1.f,1.f,
-        -10.f,5.f,10.f, 0.7f,0.7f,0.7f, 0.f,1.f,
-
-        -10.f,0.f,-10.f, 0.7f,0.7f,0.7f, 0.f,0.f,
-        -10.f,0.f,10.f, 0.7f,0.7f,0.7f, 1.f,0.f,
-        -10.f,5.f,10.f, 0.7f,0.7f,0.7f, 1.f,1.f,
-        -10.f,5.f,-10.f,0.7f,0.7f,0.7f, 0.f,1.f,
-
-         10.f,0.f,-10.f,0.7f,0.7f,0.7f, 0.f,0.f,
-         10.f,0.f,10.f, 0.7f,0.7f,0.7f, 1.f,0.f,
-         10.f,5.f,10.f, 0.7f,0.7f,0.7f, 1.f,1.f,
-         10.f,5.f,-10.f,0.7f,0.7f,0.7f, 0.f,1.f,
-
-        -10.f,5.f,-10.f,0.7f,0.7f,0.7f, 0.f,0.f,
-         10.f,5.f,-10.f,0.7f,0.7f,0.7f, 1.f,0.f,
-         10.f,5.f,10.f, 0.7f,0.7f,0.7f, 1.f,1.f,
-        -10.f,5.f,10.f, 0.7f,0.7f,0.7f, 0.f,1.f,
-
-        -10.f,0.f,-10.f,0.7f,0.7f,0.7f, 0.f,0.f,
-         10.f,0.f,-10.f,0.7f,0.7f,0.7f, 1.f,0.f,
-         10.f,0.f,10.f, 0.7f,0.7f,0.7f, 1.f,1.f,
-        -10.f,0.f,10.f, 0.7f,0.7f,0.7f, 0.f,1.f
-    };
+    // A --model is loaded before the pool is created too, so the pool can be
+    // sized for both, with 32-bit indices only if a mesh needs them.
+    ModelData model;
+    if (!opts.modelPath.empty()) {
+        PROFILE_ZONE("LoadModel");
+        Uint64 modelStart = SDL_GetPerformanceCounter();
+        if (!loadModel(opts.modelPath, model)) return -1;
+        fitModel(model, 2.0f);
+        std::cout << "Loaded " << opts.modelPath << " (" << model.vertices.size() << " vertices, "
+                  << model.indices.size() / 3 << " triangles) in "
+                  << elapsedMs(modelStart, SDL_GetPerformanceCounter()) << " ms" << std::endl;
+    }
 
-    unsigned int indices[] = {
-        0,1,2, 2,3,0,
-        4,5,6, 6,7,4,
-        8,9,10, 10,11,8,
-        12,13,14, 14,15,12,
-        16,17,18, 18,19,16,
-        20,21,22, 22,23,20
+    // Every mesh shares one vertex and one index buffer, so any mix of them
+    // can be drawn without rebinding.
+    size_t largestMesh = model.vertices.size();
+    for (const LevelMesh& mesh : level.meshes) largestMesh = std::max<size_t>(largestMesh, mesh.vertexCount);
+    MeshPool meshPool;
+    if (!meshPool.init(vertexFormat, (1 << 16) + level.vertices.size() + model.vertices.size(),
+                       (3 << 16) + level.indices.size() + model.indices.size(),
+                       largestMesh > 65536 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT))
+        return -1;
+    std::cout << "Vertex format: " << vertexFormatName(vertexFormat) << " (" << vertexStride(vertexFormat)
+              << " bytes per vertex)" << std::endl;
+
+    // Static meshes, each drawn once per frame with its own Object block.
+    struct StaticDraw {
+        MeshRange mesh;
+        InstanceData instance;
     };
+    std::vector<StaticDraw> staticDraws;
+    std::vector<GLintptr> staticOffsets;
+    Camera startCamera;
+    {
+        std::vector<MeshRange> levelMeshes(level.meshes.size());
+        std::vector<float> materialLayers(level.materials.size(), 0.0f);
+        for (size_t i = 0; i < level.materials.size(); ++i) {
+            const char* texture = level.materials[i].texture;
+            auto it = std::find(textureNames.begin(), textureNames.end(), texture);
+            if (it == textureNames.end()) std::cerr << "Level texture not found: " << texture << std::endl;
+            else materialLayers[i] = float(textureNameLayers[size_t(it - textureNames.begin())]);
+        }
+        // Level vertices carry their material as a table row, so a mesh
+        // textured per face is still one draw.
+        if (!meshPool.setMaterialLayers(materialLayers.data(), materialLayers.size())) return -1;
+        for (size_t i = 0; i < level.meshes.size(); ++i) {
+            const LevelMesh& mesh = level.meshes[i];
+            if (!meshPool.add(&level.vertices[mesh.firstVertex], mesh.vertexCount, &level.indices[mesh.firstIndex],
+                              mesh.indexCount, levelMeshes[i]))
+                return -1;
+        }
+        for (const LevelEntity& e : level.entities) {
+            glm::vec3 position{e.position[0], e.position[1], e.position[2]};
+            if (e.kind == LevelPlayerStart) {
+                startCamera.position = position;
+                startCamera.yaw = e.yaw;
+                continue;
+            }
+            glm::mat4 transform = glm::translate(glm::mat4(1.0f), position);
+            transform = glm::rotate(transform, glm::radians(e.yaw), {0.0f, 1.0f, 0.0f});
+            transform = glm::scale(transform, glm::vec3(e.scale));
+            staticDraws.push_back({levelMeshes[e.mesh], {transform, 0.0f, {0.0f, 0.0f, 0.0f}}});
+        }
+    }
+    if (!model.indices.empty()) {
+        MeshRange modelMesh;
+        if (!meshPool.addOptimized(opts.modelPath.c_str(), std::move(model.vertices), std::move(model.indices),
+                                   modelMesh))
+            return -1;
+        staticDraws.push_back({modelMesh, {glm::mat4(1.0f), 0.0f, {0.0f, 0.0f, 0.0f}}});
+    }
+    IndirectDraws indirectDraws;
+    if (opts.multiDrawIndirect) {
+        indirectDraws.init();
+        std::cout << "Scene submission: " << indirectDraws.modeName() << std::endl;
+    }
 
-    GLuint VAO, VBO, EBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    glBindVertexArray(0);
+    MeshRange crateMesh;
+    Scene scene;
+    std::vector<uint32_t> visibleObjects;
+    std::vector<InstanceData> visibleInstances;
+    PhysicsWorld physics;
+    {
+        PROFILE_ZONE("InitPhysics");
+        physics.init(jobs);
+        for (const LevelCollider& c : level.colliders)
+            physics.addStaticBox({c.center[0], c.center[1], c.center[2]},
+                                 {c.halfExtents[0], c.halfExtents[1], c.halfExtents[2]});
+    }
+    World world;
+    if (drawInstancesEnabled) {
+        createCubeMesh(meshPool, crateMesh);
+        // Unit cube corners are sqrt(3)/2 from its centre.
+        scene.addInstances(makeCrateScene(size_t(opts.crates), textureLayers), 0.8660254f);
+        spawnRigidBodies(world, physics, scene, size_t(opts.rigidBodies), textureLayers);
+        if (!opts.linearCull) {
+            PROFILE_ZONE("BuildBvh");
+            scene.buildBvh();
+        }
+    }
 
+    // Frame constants, one block per static mesh and, on the per-object
+    // path, one per crate; 256 bytes covers the largest offset alignment
+    // drivers report.
+    UniformRing uniforms;
+    uniforms.init(256 * (1 + staticDraws.size() + (opts.perObjectDraws ? scene.size() : 0)));
 
     glm::mat4 projection = glm::perspective(glm::radians(60.0f), width / float(height), 0.1f, 100.0f);
 
     bool running = true;
-    Camera cam;
-    float velY = 0.0f;
-    bool onGround = true;
-    Uint32 lastTicks = SDL_GetTicks();
+
+    // Simulation advances in fixed ticks fed by an accumulator; rendering
+    // interpolates between the previous and current tick so it can run at
+    // any rate without changing physics behaviour.
+    const double tickSeconds = 1.0 / opts.tickRate;
+    const double maxFrameSeconds = 0.25;   // avoid a catch-up spiral after a stall
+    double accumulator = 0.0;
+    Entity player = createPlayer(world, physics, startCamera);
+    SystemScheduler tickSystems;
+    addTickSystems(tickSystems, physics);
+    Uint64 lastCounter = SDL_GetPerformanceCounter();
+
+    FrameStats stats;
+    GpuTimer gpuTimer;
+    gpuTimer.init();
+    auto recordGpuTimes = [&](const std::vector<GpuFrameTimes>& results) {
+        for (const GpuFrameTimes& t : results) {
+            stats.recordGpu(t.frame, t.totalMs);
+            for (const GpuPassTime& pass : t.passes) {
+                stats.recordGpuPass(t.frame, pass.name, pass.ms);
+                profilerAddZone("GPU", pass.name, uint64_t(int64_t(pass.startNs) + gpuTimer.cpuOffsetNs),
+                                uint64_t(pass.ms * 1.0e6));
+            }
+        }
+    };
 
     while (running) {
+        PROFILE_ZONE("Frame");
+        Uint64 frameStart = SDL_GetPerformanceCounter();
+        size_t frame = stats.frameCount();
+        uint64_t glIssued = gl.issued, glSkipped = gl.skipped;
         SDL_Event e; int dx = 0, dy = 0;
-        while (SDL_PollEvent(&e)) {
-            if (e.type == SDL_QUIT) running = false;
-            if (e.type == SDL_MOUSEMOTION) { dx += e.motion.xrel; dy += e.motion.yrel; }
+        {
+            PROFILE_ZONE("PollEvents");
+            while (SDL_PollEvent(&e)) {
+                if (e.type == SDL_QUIT) running = false;
+                if (e.type == SDL_MOUSEMOTION) { dx += e.motion.xrel; dy += e.motion.yrel; }
+                if (e.type == SDL_KEYDOWN && e.key.keysym.scancode == SDL_SCANCODE_F9 && !opts.tracePath.empty())
+                    profilerWriteTrace(opts.tracePath);
+            }
         }
-        Uint32 currentTicks = SDL_GetTicks();
-        float deltaTime = (currentTicks - lastTicks) / 1000.0f;
-        lastTicks = currentTicks;
+        double frameSeconds = elapsedMs(lastCounter, frameStart) / 1000.0;
+        lastCounter = frameStart;
 
         const Uint8* keystate = SDL_GetKeyboardState(NULL);
         if (keystate[SDL_SCANCODE_ESCAPE]) running = false;
 
-        processInput(cam, deltaTime, velY, onGround, keystate, dx, dy);
+        Camera& cam = *world.get<Camera>(player);
+        if (!benchmark) {
+            PROFILE_ZONE("ProcessInput");
+            world.get<PlayerControl>(player)->input = processInput(cam, keystate, dx, dy);
+        }
+        size_t ticks = 0;
+        double physicsMs = 0.0;
+        {
+            PROFILE_ZONE("Simulate");
+            // Benchmarks run one tick per frame so the simulated work does not
+            // depend on how fast each frame happened to be.
+            accumulator += benchmark ? tickSeconds : std::min(frameSeconds, maxFrameSeconds);
+            while (accumulator >= tickSeconds) {
+                tickSystems.run(world, jobs, float(tickSeconds));
+                physicsMs += physics.stepMs.back();
+                accumulator -= tickSeconds;
+                ++ticks;
+            }
+        }
+        if (ticks && physics.dynamicBodyCount()) {
+            PROFILE_ZONE("SyncBodies");
+            syncRigidBodies(world, jobs, physics, scene);
+            scene.refitBvh();
+        }
+        if (benchmark) {
+            // The benchmark camera is a function of the frame index only, so runs
+            // are comparable regardless of how fast each frame was.
+            flythrough.apply(cam, float(frame) / float(opts.frames));
+        } else {
+            float alpha = float(accumulator / tickSeconds);
+            cam.position = glm::mix(world.get<PreviousPosition>(player)->value,
+                                    world.get<Position>(player)->value, alpha);
+        }
 
+        if (!shadersReported) {
+            PROFILE_ZONE("PollShaders");
+            shaders.poll();
+            if (shaders.done()) {
+                std::cout << "Shader programs ready in " << elapsedMs(shaderStart, SDL_GetPerformanceCounter())
+                          << " ms (" << (shaders.parallel() ? "parallel compile" : "serial compile");
+                if (programCache.enabled())
+                    std::cout << ", " << programCache.hits << " cached, " << programCache.misses << " compiled, "
+                              << programCache.rejected << " rejected";
+                std::cout << ")" << std::endl;
+                shadersReported = true;
+            }
+        }
+        if (!texturesReported) {
+            PROFILE_ZONE("StreamTextures");
+            textureStreamer.pump(4);
+            if (textureStreamer.done()) {
+                std::cout << "Textures streamed in "
+                          << elapsedMs(textureStart, SDL_GetPerformanceCounter()) << " ms" << std::endl;
+                textures.printReport(std::cout);
+                texturesReported = true;
+            }
+        }
+
+        gpuTimer.beginFrame(frame);
+        gpuTimer.beginPass("Clear");
         glClearColor(0.1f, 0.1f, 0.2f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        gpuTimer.endPass();
+
+        glm::mat4 viewProj = projection * cam.getViewMatrix();
+        {
+            PROFILE_ZONE("UploadUniforms");
+            uniforms.beginFrame();
+            FrameUniforms frameUniforms{viewProj};
+            GLintptr offset = uniforms.allocate(&frameUniforms, sizeof(frameUniforms));
+            uniforms.upload();
+            gl.bindBufferRange(GL_UNIFORM_BUFFER, frameUniformBinding, uniforms.buffer, offset, sizeof(frameUniforms));
+        }
+        textures.beginFrame();
+        gl.bindTexture(0, GL_TEXTURE_2D_ARRAY, textures.texture(textureArray));
+        textures.touch(textureArray);
+        if (texturesReported) textures.enforceBudget();
+        double cullMs = 0.0;
+        if (scene.size()) {
+            PROFILE_ZONE("Cull");
+            Uint64 cullStart = SDL_GetPerformanceCounter();
+            cullScene(scene, extractFrustum(viewProj), visibleObjects, &jobs);
+            cullMs = elapsedMs(cullStart, SDL_GetPerformanceCounter());
+            visibleInstances.resize(visibleObjects.size());
+            jobs.parallelFor(visibleObjects.size(), 8192, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) visibleInstances[i] = scene.instances[visibleObjects[i]];
+            });
+        }
+        if (opts.multiDrawIndirect) {
+            // Static meshes are more instances, after the crates. Per-object
+            // mode records a command per crate; the submission is still one
+            // call.
+            PROFILE_ZONE("DrawScene");
+            gpuTimer.beginPass("Scene");
+            size_t crates = visibleObjects.size();
+            visibleInstances.resize(crates);
+            for (const StaticDraw& draw : staticDraws) visibleInstances.push_back(draw.instance);
+            meshPool.uploadInstances(visibleInstances.data(), visibleInstances.size());
+            indirectDraws.clear();
+            if (opts.perObjectDraws) {
+                for (size_t i = 0; i < crates; ++i) indirectDraws.add(crateMesh, GLuint(i), 1);
+            } else {
+                indirectDraws.add(crateMesh, 0, GLuint(crates));
+            }
+            for (size_t i = 0; i < staticDraws.size(); ++i)
+                indirectDraws.add(staticDraws[i].mesh, GLuint(crates + i), 1);
+            drawIndirect(instanceRenderer, meshPool, indirectDraws);
+            gpuTimer.endPass();
+        } else {
+            {
+                PROFILE_ZONE("DrawRoom");
+                gpuTimer.beginPass("Room");
+                staticOffsets.resize(staticDraws.size());
+                for (size_t i = 0; i < staticDraws.size(); ++i)
+                    staticOffsets[i] = uniforms.allocate(&staticDraws[i].instance, sizeof(InstanceData));
+                uniforms.upload();
+                // Nothing to draw with until the fallback has compiled.
+                const GLuint roomProgram = shaders.program(roomShader);
+                if (roomProgram) gl.useProgram(roomProgram);
+                for (size_t i = 0; roomProgram && i < staticDraws.size(); ++i) {
+                    // Ring full: skip this mesh, counted in UniformRing::overflows.
+                    if (staticOffsets[i] < 0) continue;
+                    gl.bindBufferRange(GL_UNIFORM_BUFFER, objectUniformBinding, uniforms.buffer, staticOffsets[i],
+                                       sizeof(InstanceData));
+                    meshPool.draw(staticDraws[i].mesh);
+                }
+                gpuTimer.endPass();
+            }
+            if (scene.size()) {
+                PROFILE_ZONE("DrawCrates");
+                gpuTimer.beginPass("Crates");
+                if (!opts.perObjectDraws) meshPool.uploadInstances(visibleInstances.data(), visibleInstances.size());
+                drawInstances(instanceRenderer, meshPool, crateMesh, visibleInstances, uniforms, opts.perObjectDraws);
+                gpuTimer.endPass();
+            }
+        }
+        uniforms.endFrame();
+        gpuTimer.endFrame();
+        double cpuMs = elapsedMs(frameStart, SDL_GetPerformanceCounter());
 
-        glm::mat4 view = cam.getViewMatrix();
-        glm::mat4 mvp = projection * view;
-        glUseProgram(program);
-        glUniformMatrix4fv(glGetUniformLocation(program, "uMVP"), 1, GL_FALSE, glm::value_ptr(mvp));
-        glBindVertexArray(VAO);
-        for (int i = 0; i < 6; ++i) {
-            glBindTexture(GL_TEXTURE_2D, faceTex[i]);
-            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(i * 6 * sizeof(unsigned int)));
+        if (!opts.headless) {
+            PROFILE_ZONE("SwapWindow");
+            SDL_GL_SwapWindow(window);
         }
-        glBindVertexArray(0);
-        SDL_GL_SwapWindow(window);
+        stats.recordFrame(elapsedMs(frameStart, SDL_GetPerformanceCounter()), cpuMs);
+        if (scene.size()) {
+            stats.recordCounter(frame, "visible_objects", double(visibleObjects.size()));
+            stats.recordCounter(frame, "culled_objects", double(scene.size() - visibleObjects.size()));
+            stats.recordCounter(frame, "cull_ms", cullMs);
+        }
+        stats.recordCounter(frame, "gl_calls_issued", double(gl.issued - glIssued));
+        stats.recordCounter(frame, "gl_calls_skipped", double(gl.skipped - glSkipped));
+        if (opts.multiDrawIndirect) stats.recordCounter(frame, "indirect_commands", double(indirectDraws.size()));
+        stats.recordCounter(frame, "uniform_bytes", double(uniforms.frameBytes()));
+        stats.recordCounter(frame, "uniform_wait_ms", uniforms.lastWaitMs);
+        stats.recordCounter(frame, "texture_bytes", double(textures.residentBytes()));
+        stats.recordCounter(frame, "physics_ticks", double(ticks));
+        stats.recordCounter(frame, "physics_step_ms", physicsMs);
+        {
+            PROFILE_ZONE("CollectGpuTimers");
+            recordGpuTimes(gpuTimer.collect());
+        }
+        if (opts.frames > 0 && stats.frameCount() >= size_t(opts.frames)) running = false;
+    }
+
+    recordGpuTimes(gpuTimer.collect(true));
+    gpuTimer.shutdown();
+    if (gpuTimer.droppedFrames)
+        std::cerr << "GPU timer dropped " << gpuTimer.droppedFrames << " frames" << std::endl;
+    if (uniforms.overflows)
+        std::cerr << "Uniform ring overflowed " << uniforms.overflows << " times" << std::endl;
+    if (opts.headless || opts.frames > 0) {
+        stats.printSummary(std::cout);
+        TimingSummary step = summarize(physics.stepMs);
+        std::cout << "Physics step (" << physics.dynamicBodyCount() << " bodies, "
+                  << (physics.multithreaded() ? "multithreaded" : "single threaded") << "): "
+                  << step.count << " ticks, avg " << step.avg << " ms, p95 " << step.p95
+                  << " ms, max " << step.max << " ms" << std::endl;
+    }
+    if (!opts.csvPath.empty()) stats.writeCsv(opts.csvPath);
+    if (!opts.tracePath.empty()) profilerWriteTrace(opts.tracePath);
+    if (benchmark) {
+        std::string label = std::to_string(width) + "x" + std::to_string(height) + " " +
+                            reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+        stats.writeJson(opts.benchmarkPath, label);
     }
 
-    glDeleteProgram(program);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
-    glDeleteVertexArrays(1, &VAO);
+    textureStreamer.stop();
+    jobs.shutdown();
+    destroyInstanceRenderer(instanceRenderer);
+    indirectDraws.destroy();
+    meshPool.destroy();
+    textures.release(textureArray);
+    if (textures.liveCount()) std::cerr << textures.liveCount() << " textures still referenced at exit" << std::endl;
+    textures.releaseAll();
+    if (opts.headless) destroyOffscreenTarget(offscreen);
+    uniforms.shutdown();
+    shaders.destroy();
     SDL_GL_DeleteContext(context);
     SDL_DestroyWindow(window);
     SDL_Quit();
@@ -0,0 +1,310 @@
+#include "mesh_optimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ostream>
+
+namespace {
+
+constexpr int forsythCacheSize = 32;
+constexpr uint32_t forsythValenceTable = 32;
+
+// Scores are looked up, not computed: rescoring runs for every cache entry
+// after every triangle.
+struct ForsythTables {
+    float cache[forsythCacheSize];
+    float valence[forsythValenceTable];
+
+    ForsythTables() {
+        for (int i = 0; i < forsythCacheSize; ++i) {
+            // The last triangle's vertices score the same whatever order they
+            // were emitted in, and slightly lower so fresh neighbours win.
+            cache[i] = i < 3 ? 0.75f : std::pow(1.0f - float(i - 3) / float(forsythCacheSize - 3), 1.5f);
+        }
+        valence[0] = 0.0f;
+        for (uint32_t i = 1; i < forsythValenceTable; ++i) valence[i] = 2.0f / std::sqrt(float(i));
+    }
+};
+
+float forsythVertexScore(const ForsythTables& tables, int cachePosition, uint32_t liveTriangles) {
+    if (liveTriangles == 0) return -1.0f;
+    float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+    // Favour vertices with few triangles left so they leave the cache for good.
+    return score + (liveTriangles < forsythValenceTable ? tables.valence[liveTriangles]
+                                                        : 2.0f / std::sqrt(float(liveTriangles)));
+}
+
+uint64_t hashVertex(const Vertex& v) {
+    uint32_t words[sizeof(Vertex) / 4];
+    std::memcpy(words, &v, sizeof(Vertex));
+    uint64_t h = 0;
+    for (uint32_t w : words) h = (h ^ w) * 0x9E3779B97F4A7C15ull;
+    return h ^ (h >> 29);
+}
+
+// Misses of one FIFO cache step per index, with stamps as in
+// analyzeVertexCache().
+struct FifoCache {
+    std::vector<uint32_t> stamps;
+    uint32_t time;
+    unsigned size;
+
+    FifoCache(size_t vertexCount, unsigned cacheSize) : stamps(vertexCount, 0), time(cacheSize + 1), size(cacheSize) {}
+    unsigned access(uint32_t v) {
+        if (time - stamps[v] <= size) return 0;
+        stamps[v] = time++;
+        return 1;
+    }
+    void reset() { time += size + 1; }
+};
+
+} // namespace
+
+VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, unsigned cacheSize) {
+    VertexCacheStats stats;
+    if (indices.empty()) return stats;
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<bool> referenced(vertexCount, false);
+    size_t misses = 0, unique = 0;
+    for (uint32_t v : indices) {
+        misses += cache.access(v);
+        if (!referenced[v]) {
+            referenced[v] = true;
+            ++unique;
+        }
+    }
+    stats.acmr = float(misses) / float(indices.size() / 3);
+    stats.atvr = float(misses) / float(unique);
+    return stats;
+}
+
+void deduplicateVertices(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    // Open addressing over vertex indices; equal bytes means equal vertex
+    // (Vertex is all floats, no padding).
+    size_t capacity = 16;
+    while (capacity < vertices.size() * 2) capacity *= 2;
+    std::vector<uint32_t> table(capacity, UINT32_MAX);
+    std::vector<uint32_t> remap(vertices.size());
+    std::vector<Vertex> unique;
+    unique.reserve(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        size_t slot = size_t(hashVertex(vertices[i])) & (capacity - 1);
+        while (table[slot] != UINT32_MAX && std::memcmp(&unique[table[slot]], &vertices[i], sizeof(Vertex)) != 0)
+            slot = (slot + 1) & (capacity - 1);
+        if (table[slot] == UINT32_MAX) {
+            table[slot] = uint32_t(unique.size());
+            unique.push_back(vertices[i]);
+        }
+        remap[i] = table[slot];
+    }
+    for (uint32_t& index : indices) index = remap[index];
+    vertices.swap(unique);
+}
+
+void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    // Triangles around each vertex; the first live[v] entries are the ones
+    // not yet emitted.
+    std::vector<uint32_t> live(vertexCount, 0);
+    for (uint32_t v : indices) ++live[v];
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] = offsets[v] + live[v];
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i) adjacency[fill[indices[i]]++] = uint32_t(i / 3);
+    }
+
+    const ForsythTables tables;
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) vertexScore[v] = forsythVertexScore(tables, -1, live[v]);
+    std::vector<float> triangleScore(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t)
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+    std::vector<bool> emitted(triangleCount, false);
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    uint32_t cache[forsythCacheSize + 3];
+    int cacheCount = 0;
+    size_t scan = 0;   // every triangle before scan has been emitted
+
+    size_t best = size_t(std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin());
+    while (best != SIZE_MAX) {
+        emitted[best] = true;
+        const uint32_t* tri = &indices[best * 3];
+        for (int k = 0; k < 3; ++k) {
+            uint32_t v = tri[k];
+            result.push_back(v);
+            uint32_t* list = &adjacency[offsets[v]];
+            for (uint32_t i = 0; i < live[v]; ++i) {
+                if (list[i] == best) {
+                    std::swap(list[i], list[live[v] - 1]);
+                    break;
+                }
+            }
+            --live[v];
+        }
+
+        // The triangle's vertices move to the front of the LRU cache.
+        uint32_t next[forsythCacheSize + 3];
+        int nextCount = 0;
+        for (int k = 0; k < 3; ++k) next[nextCount++] = tri[k];
+        for (int i = 0; i < cacheCount; ++i)
+            if (cache[i] != tri[0] && cache[i] != tri[1] && cache[i] != tri[2]) next[nextCount++] = cache[i];
+
+        // Rescore everything that entered, moved or fell out, then pick the
+        // best triangle touching the cache.
+        for (int i = 0; i < nextCount; ++i) cachePosition[next[i]] = i < forsythCacheSize ? i : -1;
+        for (int i = 0; i < nextCount; ++i) {
+            uint32_t v = next[i];
+            float score = forsythVertexScore(tables, cachePosition[v], live[v]);
+            float delta = score - vertexScore[v];
+            vertexScore[v] = score;
+            for (uint32_t j = 0; j < live[v]; ++j) triangleScore[adjacency[offsets[v] + j]] += delta;
+        }
+        cacheCount = std::min(nextCount, forsythCacheSize);
+        for (int i = 0; i < cacheCount; ++i) cache[i] = next[i];
+
+        best = SIZE_MAX;
+        float bestScore = -1.0f;
+        for (int i = 0; i < cacheCount; ++i) {
+            uint32_t v = cache[i];
+            for (uint32_t j = 0; j < live[v]; ++j) {
+                uint32_t t = adjacency[offsets[v] + j];
+                if (triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+        if (best == SIZE_MAX) {
+            // Nothing left around the cache; continue elsewhere in the mesh.
+            while (scan < triangleCount && emitted[scan]) ++scan;
+            if (scan < triangleCount) best = scan;
+        }
+    }
+    indices.swap(result);
+}
+
+void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, float threshold) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) return;
+    const unsigned cacheSize = 16;
+
+    // Hard boundaries: triangles that miss on all three vertices start with
+    // a cold cache, so reordering clusters there costs nothing.
+    std::vector<size_t> hard;
+    {
+        FifoCache cache(vertices.size(), cacheSize);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            unsigned misses = 0;
+            for (int k = 0; k < 3; ++k) misses += cache.access(indices[t * 3 + k]);
+            if (t == 0 || misses == 3) hard.push_back(t);
+        }
+        hard.push_back(triangleCount);
+    }
+
+    // Soft boundaries: split a hard cluster wherever the running ACMR of the
+    // current piece has dropped within threshold of the whole cluster's, so
+    // the extra cache misses from reordering stay bounded.
+    std::vector<size_t> clusters;
+    for (size_t h = 0; h + 1 < hard.size(); ++h) {
+        size_t begin = hard[h], end = hard[h + 1];
+        FifoCache cache(vertices.size(), cacheSize);
+        size_t clusterMisses = 0;
+        for (size_t i = begin * 3; i < end * 3; ++i) clusterMisses += cache.access(indices[i]);
+        float target = float(clusterMisses) / float(end - begin) * threshold;
+
+        cache.reset();
+        size_t pieceStart = begin, pieceMisses = 0;
+        clusters.push_back(begin);
+        for (size_t t = begin; t < end; ++t) {
+            for (int k = 0; k < 3; ++k) pieceMisses += cache.access(indices[t * 3 + k]);
+            if (t + 1 < end && float(pieceMisses) <= target * float(t + 1 - pieceStart)) {
+                clusters.push_back(t + 1);
+                pieceStart = t + 1;
+                pieceMisses = 0;
+                cache.reset();
+            }
+        }
+    }
+    clusters.push_back(triangleCount);
+
+    // Sort key: how far the cluster faces away from the mesh centre. Outer
+    // surfaces tend to occlude inner ones, so they are drawn first.
+    glm::vec3 meshCenter(0.0f);
+    for (const Vertex& v : vertices) meshCenter += v.position;
+    meshCenter *= 1.0f / float(std::max<size_t>(vertices.size(), 1));
+
+    struct Cluster {
+        size_t begin, end;
+        float key;
+    };
+    std::vector<Cluster> sorted;
+    sorted.reserve(clusters.size() - 1);
+    for (size_t c = 0; c + 1 < clusters.size(); ++c) {
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (size_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+            const glm::vec3& a = vertices[indices[t * 3]].position;
+            const glm::vec3& b = vertices[indices[t * 3 + 1]].position;
+            const glm::vec3& d = vertices[indices[t * 3 + 2]].position;
+            glm::vec3 n = glm::cross(b - a, d - a);   // length is twice the area
+            float triangleArea = glm::length(n);
+            centroid += (a + b + d) * (triangleArea / 3.0f);
+            normal += n;
+            area += triangleArea;
+        }
+        float normalLength = glm::length(normal);
+        float key = 0.0f;
+        if (area > 0.0f && normalLength > 0.0f)
+            key = glm::dot(centroid * (1.0f / area) - meshCenter, normal * (1.0f / normalLength));
+        sorted.push_back({clusters[c], clusters[c + 1], key});
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) { return a.key > b.key; });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (const Cluster& c : sorted) result.insert(result.end(), indices.begin() + c.begin * 3, indices.begin() + c.end * 3);
+    indices.swap(result);
+}
+
+void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+    std::vector<Vertex> ordered;
+    ordered.reserve(vertices.size());
+    for (uint32_t& index : indices) {
+        if (remap[index] == UINT32_MAX) {
+            remap[index] = uint32_t(ordered.size());
+            ordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(ordered);
+}
+
+MeshOptimizeReport optimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    MeshOptimizeReport report;
+    report.verticesBefore = vertices.size();
+    report.triangles = indices.size() / 3;
+    report.before = analyzeVertexCache(indices, vertices.size());
+    deduplicateVertices(vertices, indices);
+    optimizeVertexCache(indices, vertices.size());
+    optimizeOverdraw(indices, vertices);
+    optimizeVertexFetch(vertices, indices);
+    report.verticesAfter = vertices.size();
+    report.after = analyzeVertexCache(indices, vertices.size());
+    report.shortIndices = vertices.size() <= 65536;
+    return report;
+}
+
+void printMeshReport(std::ostream& out, const char* name, const MeshOptimizeReport& report) {
+    out << "Mesh " << name << ": " << report.triangles << " triangles, " << report.verticesBefore << " -> "
+        << report.verticesAfter << " vertices, ACMR " << report.before.acmr << " -> " << report.after.acmr
+        << ", ATVR " << report.before.atvr << " -> " << report.after.atvr << ", "
+        << (report.shortIndices ? "fits 16-bit indices" : "needs 32-bit indices") << std::endl;
+}
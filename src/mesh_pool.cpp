@@ -0,0 +1,345 @@
+#include "mesh_pool.h"
+#include "gl_state.h"
+#include "mesh_optimizer.h"
+#include <glm/gtc/packing.hpp>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// GPU layout of the compact formats; Compact stops before color.
+struct CompactVertex {
+    int16_t position[4];   // snorm16 in the mesh bounds, w unused
+    int16_t normal[2];     // octahedral, snorm16
+    uint16_t uv[2];        // half float
+    uint16_t layer;
+    uint16_t mesh;         // row of the pool's mesh table
+    uint8_t color[4];      // CompactColor only
+};
+static_assert(sizeof(CompactVertex) == 24, "unexpected CompactVertex padding");
+
+// std140 layout of the "Meshes" block: arrays of vec4.
+struct MeshTable {
+    glm::vec4 center[maxPoolMeshes];
+    glm::vec4 extent[maxPoolMeshes];
+    glm::vec4 color[maxPoolMeshes];
+};
+
+int16_t snorm16(float v) {
+    return int16_t(glm::packSnorm1x16(v));
+}
+
+// Projects the unit normal onto the octahedron |x|+|y|+|z| = 1 and unfolds
+// the lower half over the diagonals, giving two components in [-1, 1].
+void octEncode(glm::vec3 n, int16_t out[2]) {
+    float sum = std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+    float x = sum > 0.0f ? n.x / sum : 0.0f;
+    float y = sum > 0.0f ? n.y / sum : 0.0f;
+    if (n.z < 0.0f) {
+        float fx = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float fy = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = fx;
+        y = fy;
+    }
+    out[0] = snorm16(x);
+    out[1] = snorm16(y);
+}
+
+const char* floatDecodeGlsl =
+    "layout(location = 0) in vec3 aPosition;\n"
+    "layout(location = 1) in vec3 aColor;\n"
+    "layout(location = 2) in vec2 aTex;\n"
+    "layout(location = 3) in float aLayer;\n"
+    "layout(location = 9) in vec3 aNormal;\n"
+    "VertexData fetchVertex() {\n"
+    "    return VertexData(aPosition, aColor, aTex, uMaterialLayer[int(aLayer)].x, aNormal);\n"
+    "}\n";
+
+const char* compactDecodeGlsl =
+    "layout(location = 0) in vec3 aPosition;\n"    // snorm16, mesh bounds
+    "layout(location = 2) in vec2 aTex;\n"         // half float
+    "layout(location = 3) in uvec2 aLayerMesh;\n"
+    "layout(location = 9) in vec2 aNormal;\n"      // octahedral snorm16
+    "#if VERTEX_COLOR\n"
+    "layout(location = 1) in vec4 aColor;\n"       // unorm8
+    "#endif\n"
+    "layout(std140) uniform Meshes {\n"
+    "    vec4 uMeshCenter[MAX_MESHES];\n"
+    "    vec4 uMeshExtent[MAX_MESHES];\n"
+    "    vec4 uMeshColor[MAX_MESHES];\n"
+    "};\n"
+    "vec3 octDecode(vec2 e) {\n"
+    "    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));\n"
+    "    if (n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);\n"
+    "    return normalize(n);\n"
+    "}\n"
+    "VertexData fetchVertex() {\n"
+    "    uint mesh = aLayerMesh.y;\n"
+    "    VertexData v;\n"
+    "    v.position = uMeshCenter[mesh].xyz + aPosition * uMeshExtent[mesh].xyz;\n"
+    "#if VERTEX_COLOR\n"
+    "    v.color = aColor.rgb;\n"
+    "#else\n"
+    "    v.color = uMeshColor[mesh].rgb;\n"
+    "#endif\n"
+    "    v.uv = aTex;\n"
+    "    v.layer = uMaterialLayer[aLayerMesh.x].x;\n"
+    "    v.normal = octDecode(aNormal);\n"
+    "    return v;\n"
+    "}\n";
+
+} // namespace
+
+size_t vertexStride(VertexFormat format) {
+    switch (format) {
+    case VertexFormat::Float: return sizeof(Vertex);
+    case VertexFormat::Compact: return offsetof(CompactVertex, color);
+    case VertexFormat::CompactColor: return sizeof(CompactVertex);
+    }
+    return 0;
+}
+
+const char* vertexFormatName(VertexFormat format) {
+    switch (format) {
+    case VertexFormat::Float: return "float";
+    case VertexFormat::Compact: return "compact";
+    case VertexFormat::CompactColor: return "compact-color";
+    }
+    return "";
+}
+
+bool parseVertexFormat(const std::string& name, VertexFormat& format) {
+    for (VertexFormat f : {VertexFormat::Float, VertexFormat::Compact, VertexFormat::CompactColor}) {
+        if (name == vertexFormatName(f)) {
+            format = f;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string vertexShaderSource(VertexFormat format, const char* body) {
+    std::string src = "#version 330 core\n";
+    if (format != VertexFormat::Float) {
+        src += "#define VERTEX_COLOR " + std::string(format == VertexFormat::CompactColor ? "1" : "0") + "\n";
+        src += "#define MAX_MESHES " + std::to_string(maxPoolMeshes) + "\n";
+    }
+    src += "#define MAX_MATERIALS " + std::to_string(maxPoolMaterials) + "\n";
+    src += "struct VertexData { vec3 position; vec3 color; vec2 uv; float layer; vec3 normal; };\n";
+    src += "layout(std140) uniform Materials { vec4 uMaterialLayer[MAX_MATERIALS]; };\n";
+    src += format == VertexFormat::Float ? floatDecodeGlsl : compactDecodeGlsl;
+    src += body;
+    return src;
+}
+
+bool MeshPool::init(VertexFormat vertexFormat, size_t maxVertices, size_t maxIndices, GLenum indices) {
+    format = vertexFormat;
+    indexType = indices;
+    vertexCapacity = maxVertices;
+    indexCapacity = maxIndices;
+    const size_t stride = vertexStride(format);
+    // Clear stale errors so an out-of-memory below is this pool's.
+    while (glGetError() != GL_NO_ERROR) {}
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+    glGenBuffers(1, &instanceVbo);
+    GlState& gl = glState();
+    gl.bindVertexArray(vao);
+    gl.bindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(maxVertices * stride), nullptr, GL_STATIC_DRAW);
+    gl.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(maxIndices * indexSize()), nullptr, GL_STATIC_DRAW);
+
+    if (format == VertexFormat::Float) {
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, GLsizei(stride), (void*)offsetof(Vertex, position));
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, GLsizei(stride), (void*)offsetof(Vertex, color));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, GLsizei(stride), (void*)offsetof(Vertex, uv));
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, GLsizei(stride), (void*)offsetof(Vertex, layer));
+        glVertexAttribPointer(9, 3, GL_FLOAT, GL_FALSE, GLsizei(stride), (void*)offsetof(Vertex, normal));
+        glEnableVertexAttribArray(1);
+    } else {
+        glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, GLsizei(stride), (void*)offsetof(CompactVertex, position));
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, GLsizei(stride), (void*)offsetof(CompactVertex, uv));
+        glVertexAttribIPointer(3, 2, GL_UNSIGNED_SHORT, GLsizei(stride), (void*)offsetof(CompactVertex, layer));
+        glVertexAttribPointer(9, 2, GL_SHORT, GL_TRUE, GLsizei(stride), (void*)offsetof(CompactVertex, normal));
+        if (format == VertexFormat::CompactColor) {
+            glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, GLsizei(stride), (void*)offsetof(CompactVertex, color));
+            glEnableVertexAttribArray(1);
+        }
+        glGenBuffers(1, &meshTable);
+        gl.bindBuffer(GL_UNIFORM_BUFFER, meshTable);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(MeshTable), nullptr, GL_STATIC_DRAW);
+    }
+    for (GLuint a : {0u, 2u, 3u, 9u}) glEnableVertexAttribArray(a);
+    // Zeroed, so every row is layer 0 until setMaterialLayers().
+    const std::vector<glm::vec4> materials(maxPoolMaterials, glm::vec4(0.0f));
+    glGenBuffers(1, &materialTable);
+    gl.bindBuffer(GL_UNIFORM_BUFFER, materialTable);
+    glBufferData(GL_UNIFORM_BUFFER, GLsizeiptr(materials.size() * sizeof(glm::vec4)), materials.data(), GL_STATIC_DRAW);
+
+    for (GLuint a = 4; a <= 8; ++a) {
+        glEnableVertexAttribArray(a);
+        glVertexAttribDivisor(a, 1);
+    }
+    setInstanceOffset(0);
+    gl.bindVertexArray(0);
+    if (glGetError() == GL_OUT_OF_MEMORY) {
+        std::cerr << "Failed to allocate mesh pool (" << maxVertices << " vertices, " << maxIndices << " indices)"
+                  << std::endl;
+        destroy();
+        return false;
+    }
+    return true;
+}
+
+void MeshPool::destroy() {
+    GlState& gl = glState();
+    for (GLuint buffer : {vbo, ebo, instanceVbo, meshTable, materialTable}) gl.forgetBuffer(buffer);
+    gl.forgetVertexArray(vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ebo);
+    glDeleteBuffers(1, &instanceVbo);
+    if (meshTable) glDeleteBuffers(1, &meshTable);
+    glDeleteBuffers(1, &materialTable);
+    glDeleteVertexArrays(1, &vao);
+    *this = MeshPool{};
+}
+
+bool MeshPool::add(const Vertex* vertices, size_t count, const uint32_t* indices, size_t indicesCount,
+                   MeshRange& range) {
+    if (vertexCount + count > vertexCapacity || indexCount + indicesCount > indexCapacity) {
+        std::cerr << "Mesh pool full (" << vertexCount << "/" << vertexCapacity << " vertices, " << indexCount
+                  << "/" << indexCapacity << " indices)" << std::endl;
+        return false;
+    }
+    if (indexType == GL_UNSIGNED_SHORT && count > 65536) {
+        std::cerr << "Mesh of " << count << " vertices needs a pool with 32-bit indices" << std::endl;
+        return false;
+    }
+    const bool compact = format != VertexFormat::Float;
+    if (compact && meshCount == maxPoolMeshes) {
+        std::cerr << "Mesh pool full (" << maxPoolMeshes << " meshes)" << std::endl;
+        return false;
+    }
+    GlState& gl = glState();
+    const size_t stride = vertexStride(format);
+    const void* data = vertices;
+    std::vector<unsigned char> encoded;
+    if (compact && count) {
+        glm::vec3 lo = vertices[0].position, hi = lo;
+        for (size_t i = 1; i < count; ++i) {
+            lo = glm::min(lo, vertices[i].position);
+            hi = glm::max(hi, vertices[i].position);
+        }
+        glm::vec3 center = (lo + hi) * 0.5f;
+        // Flat meshes have a zero extent on one axis; keep the division finite.
+        glm::vec3 extent = glm::max((hi - lo) * 0.5f, glm::vec3(1e-6f));
+
+        encoded.resize(count * stride);
+        for (size_t i = 0; i < count; ++i) {
+            const Vertex& v = vertices[i];
+            CompactVertex c{};
+            glm::vec3 p = (v.position - center) / extent;
+            for (int k = 0; k < 3; ++k) c.position[k] = snorm16(p[k]);
+            octEncode(v.normal, c.normal);
+            c.uv[0] = glm::packHalf1x16(v.uv.x);
+            c.uv[1] = glm::packHalf1x16(v.uv.y);
+            c.layer = uint16_t(v.layer);
+            c.mesh = uint16_t(meshCount);
+            for (int k = 0; k < 3; ++k) c.color[k] = uint8_t(std::lround(glm::clamp(v.color[k], 0.0f, 1.0f) * 255.0f));
+            c.color[3] = 255;
+            std::memcpy(encoded.data() + i * stride, &c, stride);
+        }
+        data = encoded.data();
+
+        gl.bindBuffer(GL_UNIFORM_BUFFER, meshTable);
+        const glm::vec4 row[3] = {glm::vec4(center, 0.0f), glm::vec4(extent, 0.0f), glm::vec4(vertices[0].color, 1.0f)};
+        const size_t offsets[3] = {offsetof(MeshTable, center), offsetof(MeshTable, extent), offsetof(MeshTable, color)};
+        for (int k = 0; k < 3; ++k)
+            glBufferSubData(GL_UNIFORM_BUFFER, GLintptr(offsets[k] + meshCount * sizeof(glm::vec4)), sizeof(glm::vec4), &row[k]);
+        ++meshCount;
+    }
+    gl.bindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, GLintptr(vertexCount * stride), GLsizeiptr(count * stride), data);
+    // The element buffer binding is VAO state; bind through the pool's VAO so
+    // another VAO's binding is not disturbed.
+    gl.bindVertexArray(vao);
+    gl.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    const void* indexData = indices;
+    std::vector<uint16_t> narrow;
+    if (indexType == GL_UNSIGNED_SHORT) {
+        narrow.assign(indices, indices + indicesCount);
+        indexData = narrow.data();
+    }
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, GLintptr(indexCount * indexSize()), GLsizeiptr(indicesCount * indexSize()),
+                    indexData);
+    range.firstIndex = GLuint(indexCount);
+    range.indexCount = GLsizei(indicesCount);
+    range.baseVertex = GLint(vertexCount);
+    vertexCount += count;
+    indexCount += indicesCount;
+    return true;
+}
+
+bool MeshPool::addOptimized(const char* name, std::vector<Vertex> vertices, std::vector<uint32_t> indices,
+                            MeshRange& range) {
+    printMeshReport(std::cout, name, optimizeMesh(vertices, indices));
+    return add(vertices.data(), vertices.size(), indices.data(), indices.size(), range);
+}
+
+bool MeshPool::setMaterialLayers(const float* layers, size_t count) {
+    if (count >= maxPoolMaterials) {
+        std::cerr << "Too many materials (" << count << ", at most " << maxPoolMaterials - 1 << ")" << std::endl;
+        return false;
+    }
+    // std140 pads each float of the array to a vec4.
+    std::vector<glm::vec4> rows(count, glm::vec4(0.0f));
+    for (size_t i = 0; i < count; ++i) rows[i].x = layers[i];
+    glState().bindBuffer(GL_UNIFORM_BUFFER, materialTable);
+    glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::vec4), GLsizeiptr(count * sizeof(glm::vec4)), rows.data());
+    return true;
+}
+
+void MeshPool::uploadInstances(const InstanceData* instances, size_t count) {
+    GlState& gl = glState();
+    gl.bindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    if (count > instanceCapacity) instanceCapacity = count + count / 2;
+    // Respecifying every frame orphans the old storage, so the driver need
+    // not wait for last frame's draws.
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(instanceCapacity * sizeof(InstanceData)), nullptr, GL_DYNAMIC_DRAW);
+    if (count) glBufferSubData(GL_ARRAY_BUFFER, 0, GLsizeiptr(count * sizeof(InstanceData)), instances);
+}
+
+void MeshPool::setInstanceOffset(GLuint firstInstance) {
+    glState().bindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    const size_t base = size_t(firstInstance) * sizeof(InstanceData);
+    // A mat4 attribute occupies four consecutive locations, one per column.
+    for (int col = 0; col < 4; ++col) {
+        glVertexAttribPointer(4 + col, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (void*)(base + offsetof(InstanceData, model) + col * sizeof(glm::vec4)));
+    }
+    glVertexAttribPointer(8, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(base + offsetof(InstanceData, layer)));
+}
+
+void MeshPool::bind() {
+    GlState& gl = glState();
+    gl.bindVertexArray(vao);
+    gl.bindBufferRange(GL_UNIFORM_BUFFER, materialUniformBinding, materialTable, 0,
+                       GLsizeiptr(maxPoolMaterials * sizeof(glm::vec4)));
+    if (meshTable) gl.bindBufferRange(GL_UNIFORM_BUFFER, meshUniformBinding, meshTable, 0, sizeof(MeshTable));
+}
+
+void MeshPool::draw(const MeshRange& mesh) {
+    bind();
+    glDrawElementsBaseVertex(GL_TRIANGLES, mesh.indexCount, indexType, indexOffset(mesh.firstIndex), mesh.baseVertex);
+}
+
+void MeshPool::drawInstanced(const MeshRange& mesh, GLsizei instanceCount) {
+    if (!instanceCount) return;
+    bind();
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh.indexCount, indexType, indexOffset(mesh.firstIndex),
+                                      instanceCount, mesh.baseVertex);
+}
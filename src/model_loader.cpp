@@ -0,0 +1,622 @@
+#include "model_loader.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+namespace {
+
+// Area-weighted average of the surrounding face normals, for vertices whose
+// normal was left at zero.
+void generateMissingNormals(ModelData& model) {
+    std::vector<uint8_t> missing(model.vertices.size());
+    bool any = false;
+    for (size_t i = 0; i < model.vertices.size(); ++i) {
+        const glm::vec3& n = model.vertices[i].normal;
+        if (n.x == 0.0f && n.y == 0.0f && n.z == 0.0f) missing[i] = any = true;
+    }
+    if (!any) return;
+    for (size_t t = 0; t + 2 < model.indices.size(); t += 3) {
+        const uint32_t* tri = &model.indices[t];
+        const glm::vec3& a = model.vertices[tri[0]].position;
+        // Twice the triangle's area, pointing out of its front face.
+        glm::vec3 n = glm::cross(model.vertices[tri[1]].position - a, model.vertices[tri[2]].position - a);
+        for (int k = 0; k < 3; ++k)
+            if (missing[tri[k]]) model.vertices[tri[k]].normal += n;
+    }
+    for (size_t i = 0; i < model.vertices.size(); ++i) {
+        if (!missing[i]) continue;
+        glm::vec3& n = model.vertices[i].normal;
+        float len = glm::length(n);
+        n = len > 0.0f ? n / len : glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+}
+
+// --- Wavefront OBJ ---
+
+const char* skipSpace(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+    return p;
+}
+
+bool parseFloat(const char*& p, const char* end, float& value) {
+    p = skipSpace(p, end);
+    if (p < end && *p == '+') ++p;
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return true;
+}
+
+// Resolves a 1-based (or negative, counted back from the newest) OBJ index
+// against count elements seen so far.
+bool parseObjIndex(const char*& p, const char* end, size_t count, uint32_t& index) {
+    long long value = 0;
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc() || value == 0) return false;
+    p = result.ptr;
+    long long resolved = value > 0 ? value - 1 : (long long)count + value;
+    if (resolved < 0 || resolved >= (long long)count) return false;
+    index = uint32_t(resolved);
+    return true;
+}
+
+// A position/uv/normal combination that became one model vertex. Variants of
+// the same position form a list, so corners are matched without hashing.
+struct ObjVariant {
+    uint32_t uv;
+    uint32_t normal;
+    uint32_t next;
+};
+
+constexpr uint32_t objNone = ~0u;
+
+// --- glTF ---
+
+// Just enough JSON for a glTF header: values live in one array, linked
+// through child and sibling indices, and strings are views into the chunk
+// with escapes left as written (glTF keys never need them).
+struct JsonValue {
+    enum Type : uint8_t { Null, Bool, Number, String, Array, Object };
+    Type type = Null;
+    std::string_view key;       // member name when the parent is an object
+    std::string_view string;
+    double number = 0.0;
+    uint32_t firstChild = 0;    // 0 is the root, which is nobody's child
+    uint32_t nextSibling = 0;
+};
+
+struct JsonDocument {
+    std::vector<JsonValue> values;
+
+    bool parse(const char* begin, const char* end) {
+        p = begin;
+        last = end;
+        values.assign(1, JsonValue{});
+        if (!parseValue(0, 0)) return false;
+        skipWhitespace();
+        return p == last;
+    }
+    const JsonValue& root() const { return values[0]; }
+
+    const JsonValue* member(const JsonValue* object, std::string_view key) const {
+        if (!object || object->type != JsonValue::Object) return nullptr;
+        for (uint32_t i = object->firstChild; i; i = values[i].nextSibling)
+            if (values[i].key == key) return &values[i];
+        return nullptr;
+    }
+    std::vector<const JsonValue*> elements(const JsonValue* array) const {
+        std::vector<const JsonValue*> out;
+        if (array && array->type == JsonValue::Array)
+            for (uint32_t i = array->firstChild; i; i = values[i].nextSibling) out.push_back(&values[i]);
+        return out;
+    }
+    double number(const JsonValue* object, std::string_view key, double fallback) const {
+        const JsonValue* v = member(object, key);
+        return v && v->type == JsonValue::Number ? v->number : fallback;
+    }
+
+private:
+    const char* p = nullptr;
+    const char* last = nullptr;
+
+    void skipWhitespace() {
+        while (p < last && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) ++p;
+    }
+    bool parseString(std::string_view& out) {
+        if (p == last || *p != '"') return false;
+        const char* start = ++p;
+        while (p < last && *p != '"') p += *p == '\\' ? 2 : 1;
+        if (p >= last) return false;
+        out = std::string_view(start, size_t(p - start));
+        ++p;
+        return true;
+    }
+    bool parseLiteral(const char* word, JsonValue::Type type, double number, uint32_t index) {
+        size_t n = std::strlen(word);
+        if (size_t(last - p) < n || std::memcmp(p, word, n) != 0) return false;
+        p += n;
+        values[index].type = type;
+        values[index].number = number;
+        return true;
+    }
+    // values grows while children are parsed, so the value being filled in
+    // is always addressed by index.
+    bool parseValue(uint32_t index, int depth) {
+        skipWhitespace();
+        if (p == last || depth > 64) return false;
+        char c = *p;
+        if (c == '{' || c == '[') {
+            bool object = c == '{';
+            values[index].type = object ? JsonValue::Object : JsonValue::Array;
+            ++p;
+            skipWhitespace();
+            if (p < last && *p == (object ? '}' : ']')) {
+                ++p;
+                return true;
+            }
+            uint32_t previous = 0;
+            for (;;) {
+                std::string_view key;
+                if (object) {
+                    skipWhitespace();
+                    if (!parseString(key)) return false;
+                    skipWhitespace();
+                    if (p == last || *p++ != ':') return false;
+                }
+                uint32_t child = uint32_t(values.size());
+                values.emplace_back();
+                values[child].key = key;
+                if (!parseValue(child, depth + 1)) return false;
+                if (previous) values[previous].nextSibling = child;
+                else values[index].firstChild = child;
+                previous = child;
+                skipWhitespace();
+                if (p == last) return false;
+                char next = *p++;
+                if (next == ',') continue;
+                return next == (object ? '}' : ']');
+            }
+        }
+        if (c == '"') {
+            values[index].type = JsonValue::String;
+            return parseString(values[index].string);
+        }
+        if (c == 't') return parseLiteral("true", JsonValue::Bool, 1.0, index);
+        if (c == 'f') return parseLiteral("false", JsonValue::Bool, 0.0, index);
+        if (c == 'n') return parseLiteral("null", JsonValue::Null, 0.0, index);
+        auto result = std::from_chars(p, last, values[index].number);
+        if (result.ec != std::errc()) return false;
+        values[index].type = JsonValue::Number;
+        p = result.ptr;
+        return true;
+    }
+};
+
+constexpr uint32_t glbMagic = 0x46546C67;        // "glTF"
+constexpr uint32_t glbChunkJson = 0x4E4F534A;    // "JSON"
+constexpr uint32_t glbChunkBin = 0x004E4942;     // "BIN\0"
+
+uint32_t readU32(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// One accessor resolved to a strided view into the binary chunk.
+struct GltfAccessor {
+    const unsigned char* data = nullptr;
+    size_t count = 0;
+    size_t stride = 0;
+    int componentType = 0;
+    int components = 0;
+    bool normalized = false;
+
+    float get(size_t i, int c) const {
+        const unsigned char* p = data + i * stride;
+        switch (componentType) {
+        case 5120: { int8_t v = int8_t(p[c]); return normalized ? std::max(v / 127.0f, -1.0f) : float(v); }
+        case 5121: return normalized ? p[c] / 255.0f : float(p[c]);
+        case 5122: { int16_t v; std::memcpy(&v, p + c * 2, 2); return normalized ? std::max(v / 32767.0f, -1.0f) : float(v); }
+        case 5123: { uint16_t v; std::memcpy(&v, p + c * 2, 2); return normalized ? v / 65535.0f : float(v); }
+        case 5125: return float(readU32(p + c * 4));
+        default: { float v; std::memcpy(&v, p + c * 4, 4); return v; }
+        }
+    }
+    uint32_t index(size_t i) const {
+        const unsigned char* p = data + i * stride;
+        if (componentType == 5121) return p[0];
+        if (componentType == 5123) { uint16_t v; std::memcpy(&v, p, 2); return v; }
+        return readU32(p);
+    }
+};
+
+size_t componentSize(int componentType) {
+    switch (componentType) {
+    case 5120: case 5121: return 1;
+    case 5122: case 5123: return 2;
+    case 5125: case 5126: return 4;
+    default: return 0;
+    }
+}
+
+int componentCount(std::string_view type) {
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    return 0;
+}
+
+// glTF counts, offsets and indices arrive as JSON doubles. Only whole,
+// non-negative values a GLB could address become a size_t; NaN, infinities
+// and anything that is not a Number fail.
+bool wholeNumber(double value, size_t& out) {
+    if (!(value >= 0.0 && value <= 4294967295.0) || value != std::floor(value)) return false;
+    out = size_t(value);
+    return true;
+}
+
+bool wholeNumber(const JsonValue* value, size_t& out) {
+    return value && value->type == JsonValue::Number && wholeNumber(value->number, out);
+}
+
+// Node transform from either "matrix" or translation/rotation/scale.
+glm::mat4 nodeTransform(const JsonDocument& doc, const JsonValue* node) {
+    glm::mat4 m(1.0f);
+    auto matrix = doc.elements(doc.member(node, "matrix"));
+    if (matrix.size() == 16) {
+        for (int i = 0; i < 16; ++i) m[i / 4][i % 4] = float(matrix[size_t(i)]->number);
+        return m;
+    }
+    auto read = [&](const char* key, float* out, size_t n) {
+        auto values = doc.elements(doc.member(node, key));
+        if (values.size() == n)
+            for (size_t i = 0; i < n; ++i) out[i] = float(values[i]->number);
+    };
+    float t[3] = {0.0f, 0.0f, 0.0f}, r[4] = {0.0f, 0.0f, 0.0f, 1.0f}, s[3] = {1.0f, 1.0f, 1.0f};
+    read("translation", t, 3);
+    read("rotation", r, 4);
+    read("scale", s, 3);
+    const float x = r[0], y = r[1], z = r[2], w = r[3];
+    m[0] = glm::vec4(1 - 2 * (y * y + z * z), 2 * (x * y + w * z), 2 * (x * z - w * y), 0.0f) * s[0];
+    m[1] = glm::vec4(2 * (x * y - w * z), 1 - 2 * (x * x + z * z), 2 * (y * z + w * x), 0.0f) * s[1];
+    m[2] = glm::vec4(2 * (x * z + w * y), 2 * (y * z - w * x), 1 - 2 * (x * x + y * y), 0.0f) * s[2];
+    m[3] = glm::vec4(t[0], t[1], t[2], 1.0f);
+    return m;
+}
+
+} // namespace
+
+bool parseObj(const char* text, size_t size, const char* name, ModelData& model) {
+    model.vertices.clear();
+    model.indices.clear();
+    std::vector<glm::vec3> positions, colors, normals;
+    std::vector<glm::vec2> uvs;
+    std::vector<uint32_t> firstVariant;    // per position
+    std::vector<ObjVariant> variants;      // per model vertex
+    std::vector<uint32_t> corners;
+
+    const char* p = text;
+    const char* end = text + size;
+    size_t line = 0;
+    auto fail = [&](const char* why) {
+        std::cerr << name << ":" << line << ": " << why << std::endl;
+        return false;
+    };
+    while (p < end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+        if (!eol) eol = end;
+        ++line;
+        const char* s = skipSpace(p, eol);
+        const char* keyEnd = s;
+        while (keyEnd < eol && *keyEnd != ' ' && *keyEnd != '\t') ++keyEnd;
+        std::string_view key(s, size_t(keyEnd - s));
+        s = keyEnd;
+
+        if (key == "v") {
+            glm::vec3 v, c(1.0f);
+            if (!parseFloat(s, eol, v.x) || !parseFloat(s, eol, v.y) || !parseFloat(s, eol, v.z))
+                return fail("bad vertex position");
+            // Optional per-vertex colour, a common extension.
+            glm::vec3 rgb;
+            if (parseFloat(s, eol, rgb.x) && parseFloat(s, eol, rgb.y) && parseFloat(s, eol, rgb.z)) c = rgb;
+            positions.push_back(v);
+            colors.push_back(c);
+            firstVariant.push_back(objNone);
+        } else if (key == "vt") {
+            glm::vec2 t;
+            // v is optional (1D textures); it defaults to 0.
+            if (!parseFloat(s, eol, t.x)) return fail("bad texture coordinate");
+            if (!parseFloat(s, eol, t.y)) t.y = 0.0f;
+            uvs.push_back(t);
+        } else if (key == "vn") {
+            glm::vec3 n;
+            if (!parseFloat(s, eol, n.x) || !parseFloat(s, eol, n.y) || !parseFloat(s, eol, n.z))
+                return fail("bad normal");
+            normals.push_back(n);
+        } else if (key == "f") {
+            corners.clear();
+            for (;;) {
+                s = skipSpace(s, eol);
+                if (s == eol) break;
+                uint32_t position, uv = objNone, normal = objNone;
+                if (!parseObjIndex(s, eol, positions.size(), position)) return fail("bad face position index");
+                if (s < eol && *s == '/') {
+                    ++s;
+                    if (s < eol && *s != '/' && !parseObjIndex(s, eol, uvs.size(), uv))
+                        return fail("bad face texture coordinate index");
+                    if (s < eol && *s == '/') {
+                        ++s;
+                        if (!parseObjIndex(s, eol, normals.size(), normal)) return fail("bad face normal index");
+                    }
+                }
+                uint32_t vertex = firstVariant[position];
+                while (vertex != objNone && (variants[vertex].uv != uv || variants[vertex].normal != normal))
+                    vertex = variants[vertex].next;
+                if (vertex == objNone) {
+                    vertex = uint32_t(model.vertices.size());
+                    variants.push_back({uv, normal, firstVariant[position]});
+                    firstVariant[position] = vertex;
+                    model.vertices.push_back({positions[position], colors[position],
+                                              uv == objNone ? glm::vec2(0.0f) : uvs[uv], 0.0f,
+                                              normal == objNone ? glm::vec3(0.0f) : normals[normal]});
+                }
+                corners.push_back(vertex);
+            }
+            if (corners.size() < 3) return fail("face with fewer than three corners");
+            // Fan triangulation; OBJ polygons are expected to be convex.
+            for (size_t i = 1; i + 1 < corners.size(); ++i) {
+                model.indices.push_back(corners[0]);
+                model.indices.push_back(corners[i]);
+                model.indices.push_back(corners[i + 1]);
+            }
+        }
+        p = eol + 1;
+    }
+    if (model.indices.empty()) {
+        std::cerr << name << ": no faces" << std::endl;
+        return false;
+    }
+    generateMissingNormals(model);
+    return true;
+}
+
+bool parseGlb(const unsigned char* data, size_t size, const char* name, ModelData& model) {
+    model.vertices.clear();
+    model.indices.clear();
+    auto fail = [&](const char* why) {
+        std::cerr << "Invalid glTF " << name << ": " << why << std::endl;
+        return false;
+    };
+    if (size < 20 || readU32(data) != glbMagic) return fail("not a binary glTF file");
+    if (readU32(data + 4) != 2) return fail("unsupported container version");
+    size = std::min(size, size_t(readU32(data + 8)));
+
+    const char* jsonBegin = nullptr;
+    size_t jsonSize = 0;
+    const unsigned char* bin = nullptr;
+    size_t binSize = 0;
+    for (size_t offset = 12; offset + 8 <= size;) {
+        size_t length = readU32(data + offset);
+        uint32_t type = readU32(data + offset + 4);
+        if (length > size - offset - 8) return fail("truncated chunk");
+        if (type == glbChunkJson && !jsonBegin) {
+            jsonBegin = reinterpret_cast<const char*>(data + offset + 8);
+            jsonSize = length;
+        } else if (type == glbChunkBin && !bin) {
+            bin = data + offset + 8;
+            binSize = length;
+        }
+        offset += 8 + length;
+    }
+    JsonDocument doc;
+    if (!jsonBegin || !doc.parse(jsonBegin, jsonBegin + jsonSize)) return fail("bad JSON chunk");
+    const JsonValue* root = &doc.root();
+
+    auto buffers = doc.elements(doc.member(root, "buffers"));
+    for (const JsonValue* buffer : buffers)
+        if (doc.member(buffer, "uri")) return fail("external buffers are not supported");
+    auto bufferViews = doc.elements(doc.member(root, "bufferViews"));
+    auto accessors = doc.elements(doc.member(root, "accessors"));
+    auto meshes = doc.elements(doc.member(root, "meshes"));
+    auto nodes = doc.elements(doc.member(root, "nodes"));
+
+    auto openAccessor = [&](const JsonValue* indexValue, GltfAccessor& out) {
+        size_t accessorIndex = 0, viewIndex = 0;
+        if (!wholeNumber(indexValue, accessorIndex) || accessorIndex >= accessors.size()) return false;
+        const JsonValue* accessor = accessors[accessorIndex];
+        if (doc.member(accessor, "sparse")) return false;
+        if (!wholeNumber(doc.member(accessor, "bufferView"), viewIndex) || viewIndex >= bufferViews.size())
+            return false;
+        const JsonValue* view = bufferViews[viewIndex];
+        if (doc.number(view, "buffer", 0.0) != 0.0 || !bin) return false;
+        // A missing member takes the fallback; a present one must be a
+        // whole number.
+        bool valid = true;
+        auto integer = [&](const JsonValue* object, const char* key, double fallback) {
+            const JsonValue* member = doc.member(object, key);
+            size_t value = 0;
+            if (member ? !wholeNumber(member, value) : !wholeNumber(fallback, value)) valid = false;
+            return value;
+        };
+        const JsonValue* type = doc.member(accessor, "type");
+        out.componentType = int(integer(accessor, "componentType", 0.0));
+        out.components = type && type->type == JsonValue::String ? componentCount(type->string) : 0;
+        out.count = integer(accessor, "count", 0.0);
+        const JsonValue* normalized = doc.member(accessor, "normalized");
+        out.normalized = normalized && normalized->type == JsonValue::Bool && normalized->number != 0.0;
+        size_t elementSize = componentSize(out.componentType) * size_t(out.components);
+        size_t viewOffset = integer(view, "byteOffset", 0.0);
+        size_t viewLength = integer(view, "byteLength", 0.0);
+        size_t offset = integer(accessor, "byteOffset", 0.0);
+        out.stride = integer(view, "byteStride", double(elementSize));
+        if (!valid || elementSize == 0) return false;
+        if (viewOffset > binSize || viewLength > binSize - viewOffset || offset > viewLength) return false;
+        // Written so nothing can overflow: the last element must end inside
+        // the view.
+        if (out.count && (out.stride < elementSize || elementSize > viewLength - offset ||
+                          out.count > (viewLength - offset - elementSize) / out.stride + 1))
+            return false;
+        out.data = bin + viewOffset + offset;
+        return true;
+    };
+
+    auto addMesh = [&](size_t meshIndex, const glm::mat4& transform) {
+        if (meshIndex >= meshes.size()) return fail("mesh index out of range");
+        glm::vec3 axis[3] = {glm::vec3(transform[0]), glm::vec3(transform[1]), glm::vec3(transform[2])};
+        glm::vec3 origin(transform[3]);
+        // Normals go through the cofactor matrix, the inverse transpose
+        // without the division by the determinant; they are renormalised
+        // anyway, and a mirroring transform also flips the winding.
+        glm::vec3 cofactor[3] = {glm::cross(axis[1], axis[2]), glm::cross(axis[2], axis[0]),
+                                 glm::cross(axis[0], axis[1])};
+        bool mirrored = glm::dot(axis[0], cofactor[0]) < 0.0f;
+
+        for (const JsonValue* primitive : doc.elements(doc.member(meshes[meshIndex], "primitives"))) {
+            if (doc.number(primitive, "mode", 4.0) != 4.0) {
+                std::cerr << name << ": skipping a primitive that is not a triangle list" << std::endl;
+                continue;
+            }
+            const JsonValue* attributes = doc.member(primitive, "attributes");
+            GltfAccessor positions, normals, uvs, colors, indices;
+            if (!openAccessor(doc.member(attributes, "POSITION"), positions) || positions.components != 3 ||
+                positions.componentType != 5126)
+                return fail("missing or bad POSITION accessor");
+            size_t count = positions.count;
+            auto optional = [&](const char* key, GltfAccessor& out, int minComponents, int maxComponents) {
+                const JsonValue* index = doc.member(attributes, key);
+                if (!index) return true;
+                return openAccessor(index, out) && out.count == count && out.components >= minComponents &&
+                       out.components <= maxComponents;
+            };
+            if (!optional("NORMAL", normals, 3, 3) || !optional("TEXCOORD_0", uvs, 2, 2) ||
+                !optional("COLOR_0", colors, 3, 4))
+                return fail("bad vertex attribute accessor");
+
+            const uint32_t base = uint32_t(model.vertices.size());
+            model.vertices.resize(base + count);
+            for (size_t i = 0; i < count; ++i) {
+                Vertex& v = model.vertices[base + i];
+                v.position = origin + axis[0] * positions.get(i, 0) + axis[1] * positions.get(i, 1) +
+                             axis[2] * positions.get(i, 2);
+                v.normal = glm::vec3(0.0f);
+                if (normals.data) {
+                    glm::vec3 n = cofactor[0] * normals.get(i, 0) + cofactor[1] * normals.get(i, 1) +
+                                  cofactor[2] * normals.get(i, 2);
+                    float len = glm::length(n);
+                    if (len > 0.0f) v.normal = n * ((mirrored ? -1.0f : 1.0f) / len);
+                }
+                // glTF puts the UV origin at the top left, GL at the bottom left.
+                v.uv = uvs.data ? glm::vec2(uvs.get(i, 0), 1.0f - uvs.get(i, 1)) : glm::vec2(0.0f);
+                v.color = colors.data ? glm::vec3(colors.get(i, 0), colors.get(i, 1), colors.get(i, 2))
+                                      : glm::vec3(1.0f);
+                v.layer = 0.0f;
+            }
+
+            const size_t first = model.indices.size();
+            const JsonValue* indexAccessor = doc.member(primitive, "indices");
+            if (indexAccessor) {
+                if (!openAccessor(indexAccessor, indices) || indices.components != 1 ||
+                    (indices.componentType != 5121 && indices.componentType != 5123 &&
+                     indices.componentType != 5125))
+                    return fail("bad index accessor");
+                model.indices.resize(first + indices.count / 3 * 3);
+                for (size_t i = first; i < model.indices.size(); ++i) {
+                    uint32_t index = indices.index(i - first);
+                    if (index >= count) return fail("index out of range");
+                    model.indices[i] = base + index;
+                }
+            } else {
+                model.indices.resize(first + count / 3 * 3);
+                for (size_t i = first; i < model.indices.size(); ++i) model.indices[i] = base + uint32_t(i - first);
+            }
+            if (mirrored)
+                for (size_t i = first; i + 2 < model.indices.size(); i += 3)
+                    std::swap(model.indices[i + 1], model.indices[i + 2]);
+        }
+        return true;
+    };
+
+    auto scenes = doc.elements(doc.member(root, "scenes"));
+    if (scenes.empty()) {
+        // No scene graph: every mesh once, untransformed.
+        for (size_t i = 0; i < meshes.size(); ++i)
+            if (!addMesh(i, glm::mat4(1.0f))) return false;
+    } else {
+        size_t sceneIndex = 0;
+        const JsonValue* scene = doc.member(root, "scene");
+        if ((scene && !wholeNumber(scene, sceneIndex)) || sceneIndex >= scenes.size())
+            return fail("scene index out of range");
+        struct Pending {
+            size_t node;
+            glm::mat4 parent;
+            size_t depth;
+        };
+        std::vector<Pending> stack;
+        for (const JsonValue* n : doc.elements(doc.member(scenes[sceneIndex], "nodes"))) {
+            size_t node = 0;
+            if (!wholeNumber(n, node)) return fail("bad node index");
+            stack.push_back({node, glm::mat4(1.0f), 0});
+        }
+        while (!stack.empty()) {
+            Pending item = stack.back();
+            stack.pop_back();
+            // Deeper than the node count means the hierarchy has a cycle.
+            if (item.node >= nodes.size() || item.depth > nodes.size()) return fail("bad node hierarchy");
+            const JsonValue* node = nodes[item.node];
+            glm::mat4 world = item.parent * nodeTransform(doc, node);
+            const JsonValue* mesh = doc.member(node, "mesh");
+            if (mesh) {
+                size_t meshIndex = 0;
+                if (!wholeNumber(mesh, meshIndex)) return fail("bad mesh index");
+                if (!addMesh(meshIndex, world)) return false;
+            }
+            for (const JsonValue* child : doc.elements(doc.member(node, "children"))) {
+                size_t childIndex = 0;
+                if (!wholeNumber(child, childIndex)) return fail("bad node index");
+                stack.push_back({childIndex, world, item.depth + 1});
+            }
+        }
+    }
+    if (model.indices.empty()) return fail("no triangles");
+    generateMissingNormals(model);
+    return true;
+}
+
+bool loadModel(const std::string& path, ModelData& model) {
+    size_t dot = path.find_last_of('.');
+    std::string extension = dot == std::string::npos ? std::string() : path.substr(dot);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return char(std::tolower(c)); });
+    if (extension != ".obj" && extension != ".glb") {
+        std::cerr << "Unsupported model format: " << path << std::endl;
+        return false;
+    }
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Failed to open model " << path << std::endl;
+        return false;
+    }
+    if (extension == ".obj")
+        return parseObj(reinterpret_cast<const char*>(file.data()), file.size(), path.c_str(), model);
+    return parseGlb(file.data(), file.size(), path.c_str(), model);
+}
+
+void fitModel(ModelData& model, float size) {
+    if (model.vertices.empty()) return;
+    glm::vec3 lo = model.vertices[0].position, hi = lo;
+    for (const Vertex& v : model.vertices) {
+        lo = glm::min(lo, v.position);
+        hi = glm::max(hi, v.position);
+    }
+    glm::vec3 extent = hi - lo;
+    float largest = std::max(extent.x, std::max(extent.y, extent.z));
+    float scale = largest > 0.0f ? size / largest : 1.0f;
+    glm::vec3 anchor((lo.x + hi.x) * 0.5f, lo.y, (lo.z + hi.z) * 0.5f);
+    for (Vertex& v : model.vertices) v.position = (v.position - anchor) * scale;
+}
@@ -0,0 +1,114 @@
+#include "options.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+static bool parseSize(const char* s, int& w, int& h) {
+    return std::sscanf(s, "%dx%d", &w, &h) == 2 && w > 0 && h > 0;
+}
+
+void printUsage(const char* exe) {
+    std::cerr << "Usage: " << exe << " [options]\n"
+              << "  --headless        render offscreen without a visible window\n"
+              << "  --size WxH        framebuffer resolution (default 800x600)\n"
+              << "  --frames N        exit after N frames (default: run until quit)\n"
+              << "  --tick-rate HZ    fixed simulation rate (default 120)\n"
+              << "  --threads N       job system threads including the main thread (default: all cores)\n"
+              << "  --crates N        add N instanced crates to the room (stress scene)\n"
+              << "  --rigid-bodies N  drop N dynamic physics boxes into the room\n"
+              << "  --per-object-draws  draw crates with one call each, for comparison\n"
+              << "  --linear-cull     frustum cull with a linear SIMD scan instead of the BVH\n"
+              << "  --multi-draw-indirect  draw the whole scene with one glMultiDrawElementsIndirect\n"
+              << "  --vertex-format F float, compact or compact-color (default compact)\n"
+              << "  --texture-budget MB  evict least recently used mip levels above MB of textures\n"
+              << "  --level FILE      load a converted .lvl level (default room.lvl)\n"
+              << "  --model FILE      place an .obj or .glb model in the middle of the room\n"
+              << "  --csv FILE        write per-frame CPU/GPU times to FILE\n"
+              << "  --benchmark FILE  fly a fixed camera path, write frame-time percentiles to FILE\n"
+              << "  --trace FILE      record CPU zones; F9 and exit write a Chrome trace to FILE\n"
+              << "  --shader-cache DIR  program binary cache directory (default: user pref path)\n"
+              << "  --no-shader-cache compile every shader program at startup\n"
+              << "  --help            show this message\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--headless") == 0) {
+            opts.headless = true;
+        } else if (std::strcmp(arg, "--size") == 0 && hasValue) {
+            if (!parseSize(argv[++i], opts.width, opts.height)) {
+                std::cerr << "Invalid size: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (std::strcmp(arg, "--frames") == 0 && hasValue) {
+            opts.frames = std::atoi(argv[++i]);
+            if (opts.frames < 0) {
+                std::cerr << "Invalid frame count: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (std::strcmp(arg, "--tick-rate") == 0 && hasValue) {
+            opts.tickRate = std::atoi(argv[++i]);
+            if (opts.tickRate <= 0 || opts.tickRate > 1000) {
+                std::cerr << "Invalid tick rate: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (std::strcmp(arg, "--threads") == 0 && hasValue) {
+            opts.threads = std::atoi(argv[++i]);
+            if (opts.threads < 0 || opts.threads > 256) {
+                std::cerr << "Invalid thread count: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (std::strcmp(arg, "--crates") == 0 && hasValue) {
+            opts.crates = std::atoi(argv[++i]);
+            if (opts.crates < 0) {
+                std::cerr << "Invalid crate count: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (std::strcmp(arg, "--rigid-bodies") == 0 && hasValue) {
+            opts.rigidBodies = std::atoi(argv[++i]);
+            if (opts.rigidBodies < 0) {
+                std::cerr << "Invalid rigid body count: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (std::strcmp(arg, "--per-object-draws") == 0) {
+            opts.perObjectDraws = true;
+        } else if (std::strcmp(arg, "--linear-cull") == 0) {
+            opts.linearCull = true;
+        } else if (std::strcmp(arg, "--multi-draw-indirect") == 0) {
+            opts.multiDrawIndirect = true;
+        } else if (std::strcmp(arg, "--texture-budget") == 0 && hasValue) {
+            opts.textureBudgetMb = std::atof(argv[++i]);
+            if (opts.textureBudgetMb < 0) {
+                std::cerr << "Invalid texture budget: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (std::strcmp(arg, "--vertex-format") == 0 && hasValue) {
+            opts.vertexFormat = argv[++i];
+        } else if (std::strcmp(arg, "--level") == 0 && hasValue) {
+            opts.levelPath = argv[++i];
+        } else if (std::strcmp(arg, "--model") == 0 && hasValue) {
+            opts.modelPath = argv[++i];
+        } else if (std::strcmp(arg, "--csv") == 0 && hasValue) {
+            opts.csvPath = argv[++i];
+        } else if (std::strcmp(arg, "--benchmark") == 0 && hasValue) {
+            opts.benchmarkPath = argv[++i];
+        } else if (std::strcmp(arg, "--trace") == 0 && hasValue) {
+            opts.tracePath = argv[++i];
+        } else if (std::strcmp(arg, "--shader-cache") == 0 && hasValue) {
+            opts.shaderCacheDir = argv[++i];
+        } else if (std::strcmp(arg, "--no-shader-cache") == 0) {
+            opts.noShaderCache = true;
+        } else {
+            if (std::strcmp(arg, "--help") != 0)
+                std::cerr << "Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+    // Headless and benchmark runs need a fixed length: one lap of the
+    // flythrough path takes this many frames unless overridden.
+    if ((opts.headless || !opts.benchmarkPath.empty()) && opts.frames == 0) opts.frames = 1200;
+    return true;
+}
@@ -0,0 +1,94 @@
+#include "pak.h"
+#include <algorithm>
+#include <iostream>
+#include "block_compress.h"
+
+bool PakArchive::open(const std::string& path) {
+    *this = PakArchive{};
+    if (!file.open(path)) return false;
+    const unsigned char* base = file.data();
+    const uint64_t size = file.size();
+
+    auto fail = [&](const char* why) {
+        std::cerr << "Invalid pak " << path << ": " << why << std::endl;
+        *this = PakArchive{};
+        return false;
+    };
+    if (size < sizeof(PakHeader)) return fail("truncated header");
+    const PakHeader* h = reinterpret_cast<const PakHeader*>(base);
+    if (h->magic != pakMagic) return fail("bad magic");
+    if (h->version != pakVersion) return fail("unsupported version");
+    if (h->bucketCount == 0 || (h->bucketCount & (h->bucketCount - 1)) || h->bucketCount <= h->entryCount)
+        return fail("bad bucket count");
+    auto inRange = [&](uint64_t offset, uint64_t bytes) { return offset <= size && bytes <= size - offset; };
+    if (h->entriesOffset % alignof(PakEntry) || !inRange(h->entriesOffset, uint64_t(h->entryCount) * sizeof(PakEntry)) ||
+        h->bucketsOffset % alignof(uint32_t) || !inRange(h->bucketsOffset, uint64_t(h->bucketCount) * sizeof(uint32_t)) ||
+        !inRange(h->namesOffset, h->namesSize))
+        return fail("table out of range");
+    header = h;
+    entries = reinterpret_cast<const PakEntry*>(base + h->entriesOffset);
+    buckets = reinterpret_cast<const uint32_t*>(base + h->bucketsOffset);
+    names = reinterpret_cast<const char*>(base + h->namesOffset);
+
+    // Validate once here so lookups and reads can trust every field.
+    for (uint32_t i = 0; i < h->entryCount; ++i) {
+        const PakEntry& e = entries[i];
+        if (e.nameOffset > h->namesSize || e.nameLength > h->namesSize - e.nameOffset) return fail("name out of range");
+        if (e.nameHash != pakHash(name(e))) return fail("name hash mismatch");
+        if (i > 0 && !(name(entries[i - 1]) < name(e))) return fail("entries not sorted");
+        if (!inRange(e.offset, e.storedSize)) return fail("entry data out of range");
+        if (e.compression == PakStored ? e.storedSize != e.size : e.compression != PakBlock)
+            return fail("bad compression");
+        // A block expands at most 255:1, so larger sizes are corrupt and
+        // must not reach the scratch allocation in bytes().
+        if (e.compression == PakBlock && e.size > e.storedSize * 255 + 16) return fail("bad decompressed size");
+    }
+    // Every entry in exactly one bucket: together with bucketCount >
+    // entryCount this leaves an empty bucket, which find() needs to stop.
+    std::vector<bool> seen(h->entryCount, false);
+    for (uint32_t b = 0; b < h->bucketCount; ++b) {
+        if (buckets[b] == pakEmptyBucket) continue;
+        if (buckets[b] >= h->entryCount) return fail("bucket out of range");
+        if (seen[buckets[b]]) return fail("entry in several buckets");
+        seen[buckets[b]] = true;
+    }
+    if (std::find(seen.begin(), seen.end(), false) != seen.end()) return fail("entry missing from buckets");
+    return true;
+}
+
+const PakEntry* PakArchive::find(std::string_view entryName) const {
+    if (!header) return nullptr;
+    const uint64_t hash = pakHash(entryName);
+    const uint32_t mask = header->bucketCount - 1;
+    // open() checked that some bucket is empty, so probing terminates.
+    for (uint32_t b = uint32_t(hash) & mask;; b = (b + 1) & mask) {
+        const uint32_t index = buckets[b];
+        if (index == pakEmptyBucket) return nullptr;
+        const PakEntry& e = entries[index];
+        if (e.nameHash == hash && name(e) == entryName) return &e;
+    }
+}
+
+std::vector<const PakEntry*> PakArchive::list(std::string_view prefix) const {
+    std::vector<const PakEntry*> result;
+    const PakEntry* end = entries + size();
+    const PakEntry* it = std::lower_bound(entries, end, prefix,
+                                          [&](const PakEntry& e, std::string_view p) { return name(e) < p; });
+    for (; it != end && name(*it).substr(0, prefix.size()) == prefix; ++it) result.push_back(it);
+    return result;
+}
+
+std::string_view PakArchive::name(const PakEntry& entry) const {
+    return std::string_view(names + entry.nameOffset, entry.nameLength);
+}
+
+const unsigned char* PakArchive::bytes(const PakEntry& entry, std::vector<unsigned char>& scratch) const {
+    const unsigned char* stored = file.data() + entry.offset;
+    if (entry.compression == PakStored) return stored;
+    scratch.resize(size_t(entry.size));
+    if (!blockDecompress(stored, size_t(entry.storedSize), scratch.data(), scratch.size())) {
+        std::cerr << "Corrupt pak entry " << name(entry) << std::endl;
+        return nullptr;
+    }
+    return scratch.data();
+}
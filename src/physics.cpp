@@ -0,0 +1,205 @@
+#include "physics.h"
+#include "profiler.h"
+#include "timer.h"
+#include <btBulletDynamicsCommon.h>
+#include <LinearMath/btThreads.h>
+
+#if BT_THREADSAFE
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#endif
+
+#if BT_THREADSAFE
+// Routes Bullet's internal parallel loops to the engine job system instead
+// of letting Bullet start a second thread pool.
+struct JobTaskScheduler : btITaskScheduler {
+    explicit JobTaskScheduler(JobSystem& jobs) : btITaskScheduler("JobSystem"), jobs(jobs) {}
+
+    int getMaxNumThreads() const override { return int(jobs.threadCount()); }
+    int getNumThreads() const override { return int(jobs.threadCount()); }
+    void setNumThreads(int) override {}
+
+    void parallelFor(int begin, int end, int grain, const btIParallelForBody& body) override {
+        jobs.parallelFor(size_t(end - begin), size_t(grain > 0 ? grain : 1), [&](size_t b, size_t e) {
+            body.forLoop(begin + int(b), begin + int(e));
+        });
+    }
+
+    btScalar parallelSum(int begin, int end, int grain, const btIParallelSumBody& body) override {
+        size_t step = size_t(grain > 0 ? grain : 1);
+        std::vector<btScalar> sums((size_t(end - begin) + step - 1) / step, btScalar(0));
+        jobs.parallelFor(size_t(end - begin), step, [&](size_t b, size_t e) {
+            sums[b / step] = body.sumLoop(begin + int(b), begin + int(e));
+        });
+        btScalar total = 0;
+        for (btScalar s : sums) total += s;
+        return total;
+    }
+
+    JobSystem& jobs;
+};
+#endif
+
+static btVector3 toBt(const glm::vec3& v) { return btVector3(v.x, v.y, v.z); }
+static glm::vec3 toGlm(const btVector3& v) { return glm::vec3(float(v.x()), float(v.y()), float(v.z())); }
+
+PhysicsWorld::PhysicsWorld() = default;
+
+PhysicsWorld::~PhysicsWorld() {
+    // Bodies must leave the world before it, and the world before the
+    // dispatcher, solver and broadphase it points to.
+    if (dynamics) {
+        for (auto& body : bodies) dynamics->removeRigidBody(body.get());
+    }
+    bodies.clear();
+    dynamics.reset();
+    solver.reset();
+    solverPool.reset();
+    broadphase.reset();
+    dispatcher.reset();
+    config.reset();
+#if BT_THREADSAFE
+    if (scheduler) btSetTaskScheduler(nullptr);
+#endif
+    scheduler.reset();
+}
+
+bool PhysicsWorld::init(JobSystem& jobs) {
+    config = std::make_unique<btDefaultCollisionConfiguration>();
+    broadphase = std::make_unique<btDbvtBroadphase>();
+#if BT_THREADSAFE
+    scheduler = std::make_unique<JobTaskScheduler>(jobs);
+    btSetTaskScheduler(scheduler.get());
+    dispatcher = std::make_unique<btCollisionDispatcherMt>(config.get(), 40);
+    auto* pool = new btConstraintSolverPoolMt(scheduler->getNumThreads());
+    solverPool.reset(pool);
+    solver = std::make_unique<btSequentialImpulseConstraintSolverMt>();
+    dynamics = std::make_unique<btDiscreteDynamicsWorldMt>(dispatcher.get(), broadphase.get(), pool,
+                                                           solver.get(), config.get());
+#else
+    (void)jobs;
+    dispatcher = std::make_unique<btCollisionDispatcher>(config.get());
+    solver = std::make_unique<btSequentialImpulseConstraintSolver>();
+    dynamics = std::make_unique<btDiscreteDynamicsWorld>(dispatcher.get(), broadphase.get(), solver.get(), config.get());
+#endif
+    dynamics->setGravity(btVector3(0.0f, -9.8f, 0.0f));
+    return true;
+}
+
+bool PhysicsWorld::multithreaded() const {
+#if BT_THREADSAFE
+    return true;
+#else
+    return false;
+#endif
+}
+
+btCollisionShape* PhysicsWorld::ownShape(std::unique_ptr<btCollisionShape> shape) {
+    shapes.push_back(std::move(shape));
+    return shapes.back().get();
+}
+
+btCollisionShape* PhysicsWorld::boxShape(const glm::vec3& halfExtents) {
+    // Stress scenes create thousands of boxes from a few sizes; share shapes.
+    for (auto& box : boxShapes) {
+        if (box.first == halfExtents) return box.second;
+    }
+    btCollisionShape* shape = ownShape(std::make_unique<btBoxShape>(toBt(halfExtents)));
+    boxShapes.emplace_back(halfExtents, shape);
+    return shape;
+}
+
+btRigidBody* PhysicsWorld::addBody(btCollisionShape* shape, const glm::vec3& center, float mass) {
+    btTransform transform;
+    transform.setIdentity();
+    transform.setOrigin(toBt(center));
+    btVector3 inertia(0.0f, 0.0f, 0.0f);
+    if (mass > 0.0f) shape->calculateLocalInertia(mass, inertia);
+    motionStates.push_back(std::make_unique<btDefaultMotionState>(transform));
+    btRigidBody::btRigidBodyConstructionInfo info(mass, motionStates.back().get(), shape, inertia);
+    bodies.push_back(std::make_unique<btRigidBody>(info));
+    btRigidBody* body = bodies.back().get();
+    dynamics->addRigidBody(body);
+    return body;
+}
+
+void PhysicsWorld::addStaticBox(const glm::vec3& center, const glm::vec3& halfExtents) {
+    addBody(boxShape(halfExtents), center, 0.0f);
+}
+
+size_t PhysicsWorld::addDynamicBox(const glm::vec3& center, const glm::vec3& halfExtents, float mass) {
+    dynamicBodies.push_back(addBody(boxShape(halfExtents), center, mass));
+    dynamicHalfExtents.push_back(halfExtents);
+    return dynamicBodies.size() - 1;
+}
+
+glm::mat4 PhysicsWorld::bodyModel(size_t i) const {
+    btTransform transform;
+    dynamicBodies[i]->getMotionState()->getWorldTransform(transform);
+    btScalar m[16];
+    transform.getOpenGLMatrix(m);
+    glm::mat4 model;
+    for (int c = 0; c < 4; ++c)
+        for (int r = 0; r < 4; ++r) model[c][r] = float(m[c * 4 + r]);
+    glm::vec3 size = dynamicHalfExtents[i] * 2.0f;
+    model[0] = model[0] * size.x;
+    model[1] = model[1] * size.y;
+    model[2] = model[2] * size.z;
+    return model;
+}
+
+void PhysicsWorld::step(float dt) {
+    PROFILE_ZONE("PhysicsStep");
+    Uint64 start = SDL_GetPerformanceCounter();
+    dynamics->stepSimulation(dt, 1, dt);
+    stepMs.push_back(elapsedMs(start, SDL_GetPerformanceCounter()));
+}
+
+// Closest hit along a ray, ignoring one body (the character's own capsule).
+struct IgnoreBodyRayCallback : btCollisionWorld::ClosestRayResultCallback {
+    IgnoreBodyRayCallback(const btVector3& from, const btVector3& to, const btCollisionObject* ignore)
+        : ClosestRayResultCallback(from, to), ignore(ignore) {}
+
+    btScalar addSingleResult(btCollisionWorld::LocalRayResult& result, bool normalInWorldSpace) override {
+        if (result.m_collisionObject == ignore) return 1.0f;
+        return ClosestRayResultCallback::addSingleResult(result, normalInWorldSpace);
+    }
+
+    const btCollisionObject* ignore;
+};
+
+void CharacterController::init(PhysicsWorld& world, const glm::vec3& eyePosition) {
+    physics = &world;
+    btCollisionShape* shape = world.ownShape(std::make_unique<btCapsuleShape>(radius, cylinderHeight));
+    body = world.addBody(shape, eyePosition - glm::vec3(0.0f, eyeOffset, 0.0f), 70.0f);
+    // Upright, frictionless and always awake: movement comes from velocity.
+    body->setAngularFactor(btVector3(0.0f, 0.0f, 0.0f));
+    body->setFriction(0.0f);
+    body->setActivationState(DISABLE_DEACTIVATION);
+}
+
+bool CharacterController::onGround() const {
+    btVector3 from = body->getWorldTransform().getOrigin();
+    float reach = cylinderHeight * 0.5f + radius + 0.05f;
+    btVector3 to = from - btVector3(0.0f, reach, 0.0f);
+    IgnoreBodyRayCallback ray(from, to, body);
+    physics->world()->rayTest(from, to, ray);
+    return ray.hasHit();
+}
+
+void CharacterController::update(const PlayerInput& input) {
+    btVector3 velocity = body->getLinearVelocity();
+    velocity.setX(input.move.x * speed);
+    velocity.setZ(input.move.z * speed);
+    if (input.jump && onGround()) velocity.setY(jumpSpeed);
+    body->setLinearVelocity(velocity);
+}
+
+glm::vec3 CharacterController::eyePosition() const {
+    return toGlm(body->getWorldTransform().getOrigin()) + glm::vec3(0.0f, eyeOffset, 0.0f);
+}
+
+glm::vec3 CharacterController::velocity() const {
+    return toGlm(body->getLinearVelocity());
+}
@@ -0,0 +1,29 @@
+#include "player.h"
+#include <cmath>
+
+PlayerInput processInput(Camera& cam, const Uint8* keystate, int dx, int dy) {
+    const float sensitivity = 0.1f;
+
+    cam.yaw += dx * sensitivity;
+    cam.pitch -= dy * sensitivity;
+    if (cam.pitch > 89.0f) cam.pitch = 89.0f;
+    if (cam.pitch < -89.0f) cam.pitch = -89.0f;
+
+    glm::vec3 front{
+        cos(glm::radians(cam.yaw)) * cos(glm::radians(cam.pitch)),
+        0.0f,
+        sin(glm::radians(cam.yaw)) * cos(glm::radians(cam.pitch))
+    };
+    front = glm::normalize(front);
+    glm::vec3 right = glm::normalize(glm::cross(front, glm::vec3{0.0f, 1.0f, 0.0f}));
+
+    PlayerInput input;
+    glm::vec3 move(0.0f);
+    if (keystate[SDL_SCANCODE_W]) move += front;
+    if (keystate[SDL_SCANCODE_S]) move -= front;
+    if (keystate[SDL_SCANCODE_A]) move -= right;
+    if (keystate[SDL_SCANCODE_D]) move += right;
+    if (glm::length(move) > 0.0f) input.move = glm::normalize(move);
+    input.jump = keystate[SDL_SCANCODE_SPACE] != 0;
+    return input;
+}
@@ -0,0 +1,153 @@
+#include "profiler.h"
+
+#if FPS_PROFILER
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct ZoneEvent {
+    const char* name;
+    uint64_t startNs;
+    uint64_t durationNs;
+};
+
+// Each thread appends to its own buffer; the mutex is only contended while a
+// capture is being written.
+struct ThreadBuffer {
+    std::mutex mutex;
+    std::vector<ZoneEvent> events;
+    std::string name;
+    uint32_t id = 0;
+    uint64_t dropped = 0;
+};
+
+// Caps memory if a capture is left running; roughly 24 MB per thread.
+constexpr size_t maxEventsPerThread = 1 << 20;
+
+std::atomic<bool> g_enabled{false};
+std::mutex g_registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> g_buffers;   // never shrinks, threads may exit
+const auto g_epoch = std::chrono::steady_clock::now();
+
+// Caller holds g_registryMutex.
+ThreadBuffer* addBuffer() {
+    g_buffers.push_back(std::make_unique<ThreadBuffer>());
+    ThreadBuffer* b = g_buffers.back().get();
+    b->id = uint32_t(g_buffers.size());
+    b->name = "thread " + std::to_string(b->id);
+    return b;
+}
+
+ThreadBuffer& threadBuffer() {
+    thread_local ThreadBuffer* buffer = [] {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        return addBuffer();
+    }();
+    return *buffer;
+}
+
+void append(ThreadBuffer& b, const ZoneEvent& e) {
+    std::lock_guard<std::mutex> lock(b.mutex);
+    if (b.events.size() < maxEventsPerThread) b.events.push_back(e);
+    else ++b.dropped;
+}
+
+void writeEscaped(std::ostream& out, const std::string& s) {
+    for (char c : s) {
+        if (c == '"' || c == '\\') out << '\\';
+        out << c;
+    }
+}
+
+} // namespace
+
+void profilerSetEnabled(bool enabled) { g_enabled.store(enabled, std::memory_order_relaxed); }
+bool profilerEnabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+void profilerSetThreadName(const char* name) {
+    ThreadBuffer& b = threadBuffer();
+    std::lock_guard<std::mutex> lock(b.mutex);
+    b.name = name;
+}
+
+uint64_t profilerNowNs() {
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - g_epoch).count());
+}
+
+ProfileZone::ProfileZone(const char* name)
+    : name(name), startNs(profilerEnabled() ? profilerNowNs() : 0) {}
+
+ProfileZone::~ProfileZone() {
+    if (!startNs || !profilerEnabled()) return;
+    append(threadBuffer(), {name, startNs, profilerNowNs() - startNs});
+}
+
+void profilerAddZone(const char* track, const char* name, uint64_t startNs, uint64_t durationNs) {
+    if (!profilerEnabled()) return;
+    ThreadBuffer* target = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        for (auto& b : g_buffers) {
+            std::lock_guard<std::mutex> bufLock(b->mutex);
+            if (b->name == track) target = b.get();
+        }
+        if (!target) {
+            target = addBuffer();
+            target->name = track;
+        }
+    }
+    append(*target, {name, startNs, durationNs});
+}
+
+void profilerClear() {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    for (auto& b : g_buffers) {
+        std::lock_guard<std::mutex> bufLock(b->mutex);
+        b->events.clear();
+        b->dropped = 0;
+    }
+}
+
+bool profilerWriteTrace(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+    // Complete ("X") events nest by their time ranges, so zones opened inside
+    // other zones show up as children without storing the hierarchy.
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    bool first = true;
+    size_t count = 0;
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    for (auto& b : g_buffers) {
+        std::lock_guard<std::mutex> bufLock(b->mutex);
+        out << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+            << b->id << ", \"args\": {\"name\": \"";
+        writeEscaped(out, b->name);
+        out << "\"}}";
+        first = false;
+        for (const ZoneEvent& e : b->events) {
+            out << ",\n{\"name\": \"" << e.name << "\", \"cat\": \"cpu\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+                << b->id << ", \"ts\": " << e.startNs / 1000.0 << ", \"dur\": " << e.durationNs / 1000.0 << "}";
+        }
+        count += b->events.size();
+        if (b->dropped)
+            std::cerr << "Profiler: " << b->name << " dropped " << b->dropped << " zones" << std::endl;
+    }
+    out << "\n]}\n";
+    std::cout << "Wrote " << count << " profiler zones to " << path << std::endl;
+    return true;
+}
+
+#endif
@@ -0,0 +1,135 @@
+#include "scene.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SCENE_SIMD 1
+#else
+#define SCENE_SIMD 0
+#endif
+
+size_t Scene::add(const InstanceData& instance, const glm::vec3& center, float r) {
+    centerX.push_back(center.x);
+    centerY.push_back(center.y);
+    centerZ.push_back(center.z);
+    radius.push_back(r);
+    instances.push_back(instance);
+    return instances.size() - 1;
+}
+
+void Scene::addInstances(const std::vector<InstanceData>& list, float localRadius) {
+    size_t total = size() + list.size();
+    for (std::vector<float>* v : {&centerX, &centerY, &centerZ, &radius}) v->reserve(total);
+    instances.reserve(total);
+    for (const InstanceData& inst : list) {
+        const glm::mat4& m = inst.model;
+        float scale = std::max({glm::length(glm::vec3(m[0].x, m[0].y, m[0].z)),
+                                glm::length(glm::vec3(m[1].x, m[1].y, m[1].z)),
+                                glm::length(glm::vec3(m[2].x, m[2].y, m[2].z))});
+        add(inst, glm::vec3(m[3].x, m[3].y, m[3].z), localRadius * scale);
+    }
+}
+
+void Scene::setTransform(size_t i, const glm::mat4& model) {
+    instances[i].model = model;
+    centerX[i] = model[3].x;
+    centerY[i] = model[3].y;
+    centerZ[i] = model[3].z;
+}
+
+void Scene::clear() {
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    radius.clear();
+    instances.clear();
+    bvh = Bvh{};
+}
+
+std::vector<Aabb> Scene::sphereBoxes() const {
+    std::vector<Aabb> boxes(size());
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        glm::vec3 c{centerX[i], centerY[i], centerZ[i]};
+        boxes[i] = {c - glm::vec3(radius[i]), c + glm::vec3(radius[i])};
+    }
+    return boxes;
+}
+
+void Scene::buildBvh() {
+    bvh.build(sphereBoxes());
+}
+
+void Scene::refitBvh() {
+    if (!bvh.empty()) bvh.refit(sphereBoxes());
+}
+
+static bool sphereVisible(const Frustum& f, float x, float y, float z, float r) {
+    for (const glm::vec4& p : f.planes)
+        if (p.x * x + p.y * y + p.z * z + p.w < -r) return false;
+    return true;
+}
+
+// Appends the visible objects in [begin, end) to visible.
+static void cullRange(const Scene& scene, const Frustum& frustum, size_t begin, size_t end,
+                      std::vector<uint32_t>& visible) {
+    size_t i = begin;
+#if SCENE_SIMD
+    // Four spheres per iteration against all six planes; a lane stays
+    // visible while its signed distance is >= -radius for every plane.
+    __m128 px[6], py[6], pz[6], pw[6];
+    for (int p = 0; p < 6; ++p) {
+        px[p] = _mm_set1_ps(frustum.planes[p].x);
+        py[p] = _mm_set1_ps(frustum.planes[p].y);
+        pz[p] = _mm_set1_ps(frustum.planes[p].z);
+        pw[p] = _mm_set1_ps(frustum.planes[p].w);
+    }
+    const float* cx = scene.centerX.data();
+    const float* cy = scene.centerY.data();
+    const float* cz = scene.centerZ.data();
+    const float* cr = scene.radius.data();
+    for (; i + 4 <= end; i += 4) {
+        __m128 x = _mm_loadu_ps(cx + i);
+        __m128 y = _mm_loadu_ps(cy + i);
+        __m128 z = _mm_loadu_ps(cz + i);
+        __m128 negR = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(cr + i));
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px[p], x), _mm_mul_ps(py[p], y)),
+                                  _mm_add_ps(_mm_mul_ps(pz[p], z), pw[p]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negR));
+        }
+        int mask = _mm_movemask_ps(inside);
+        if (!mask) continue;
+        for (int lane = 0; lane < 4; ++lane)
+            if (mask & (1 << lane)) visible.push_back(uint32_t(i + lane));
+    }
+#endif
+    for (; i < end; ++i) {
+        if (sphereVisible(frustum, scene.centerX[i], scene.centerY[i], scene.centerZ[i], scene.radius[i]))
+            visible.push_back(uint32_t(i));
+    }
+}
+
+size_t cullScene(const Scene& scene, const Frustum& frustum, std::vector<uint32_t>& visible, JobSystem* jobs) {
+    const size_t n = scene.size();
+    visible.clear();
+    if (!scene.bvh.empty()) {
+        scene.bvh.queryFrustum(frustum, visible);
+        return visible.size();
+    }
+    visible.reserve(n);
+    // Below a few thousand objects the scan is faster than handing it out.
+    const size_t grain = 4096;
+    if (!jobs || n <= grain) {
+        cullRange(scene, frustum, 0, n, visible);
+        return visible.size();
+    }
+    // Each chunk writes its own list; concatenating them keeps index order.
+    std::vector<std::vector<uint32_t>> chunks((n + grain - 1) / grain);
+    jobs->parallelFor(n, grain, [&](size_t begin, size_t end) {
+        cullRange(scene, frustum, begin, end, chunks[begin / grain]);
+    });
+    for (const std::vector<uint32_t>& chunk : chunks) visible.insert(visible.end(), chunk.begin(), chunk.end());
+    return visible.size();
+}
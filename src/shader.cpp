@@ -0,0 +1,186 @@
+#include "shader.h"
+#include "gl_state.h"
+#include "shader_cache.h"
+#include <SDL.h>
+#include <iostream>
+
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+GLuint compileShader(GLenum type, const char* src) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &src, nullptr);
+    glCompileShader(shader);
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char log[512];
+        glGetShaderInfoLog(shader, 512, nullptr, log);
+        std::cerr << "Shader compile error: " << log << std::endl;
+    }
+    return shader;
+}
+
+GLuint createProgram(const char* vsSrc, const char* fsSrc, bool retrievable) {
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vsSrc);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fsSrc);
+    GLuint prog = glCreateProgram();
+    if (retrievable) glProgramParameteri(prog, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(prog, vs);
+    glAttachShader(prog, fs);
+    glLinkProgram(prog);
+    GLint success;
+    glGetProgramiv(prog, GL_LINK_STATUS, &success);
+    if (!success) {
+        char log[512];
+        glGetProgramInfoLog(prog, 512, nullptr, log);
+        std::cerr << "Program link error: " << log << std::endl;
+    }
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    return prog;
+}
+
+const char* const fallbackFsSrc =
+    "#version 330 core\n"
+    "in vec3 vColor;\n"
+    "out vec4 FragColor;\n"
+    "void main() {\n"
+    "    FragColor = vec4(vColor, 1.0);\n"
+    "}";
+
+void bindUniformBlock(GLuint program, const char* block, GLuint binding) {
+    GLuint index = glGetUniformBlockIndex(program, block);
+    if (index != GL_INVALID_INDEX) glUniformBlockBinding(program, index, binding);
+}
+
+size_t ShaderBatch::add(const char* vsSrc, const char* fsSrc, size_t fallback) {
+    Entry e;
+    e.vsSrc = vsSrc;
+    e.fsSrc = fsSrc;
+    e.fallback = fallback < entries.size() ? fallback : noFallback;
+    entries.push_back(std::move(e));
+    return entries.size() - 1;
+}
+
+void ShaderBatch::bindUniformBlock(const char* block, GLuint binding) {
+    blockBindings.emplace_back(block, binding);
+    for (const Entry& e : entries)
+        if (e.ready && e.program) ::bindUniformBlock(e.program, block, binding);
+}
+
+void ShaderBatch::submit(ProgramCache* programCache) {
+    cache = programCache && programCache->enabled() ? programCache : nullptr;
+
+    // Loaded through SDL rather than GLEW, whose older releases predate the
+    // extension. The ARB variant has the same token values.
+    typedef void (APIENTRY * MaxCompilerThreadsFn)(GLuint count);
+    MaxCompilerThreadsFn maxThreads = nullptr;
+    if (SDL_GL_ExtensionSupported("GL_KHR_parallel_shader_compile"))
+        maxThreads = (MaxCompilerThreadsFn)SDL_GL_GetProcAddress("glMaxShaderCompilerThreadsKHR");
+    else if (SDL_GL_ExtensionSupported("GL_ARB_parallel_shader_compile"))
+        maxThreads = (MaxCompilerThreadsFn)SDL_GL_GetProcAddress("glMaxShaderCompilerThreadsARB");
+    parallelCompile = maxThreads != nullptr;
+    if (maxThreads) maxThreads(0xFFFFFFFFu);   // let the driver pick
+
+    for (Entry& e : entries) {
+        if (e.ready || e.program) continue;
+        if (cache && (e.program = cache->loadCached(e.vsSrc.c_str(), e.fsSrc.c_str()))) {
+            e.fromCache = true;
+            continue;
+        }
+        const char* vs = e.vsSrc.c_str();
+        const char* fs = e.fsSrc.c_str();
+        e.vs = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(e.vs, 1, &vs, nullptr);
+        glCompileShader(e.vs);
+        e.fs = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(e.fs, 1, &fs, nullptr);
+        glCompileShader(e.fs);
+    }
+    // Linking waits on nothing yet: the driver chains it after the compiles.
+    for (Entry& e : entries) {
+        if (e.ready || e.fromCache || e.program) continue;
+        e.program = glCreateProgram();
+        if (cache) glProgramParameteri(e.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glAttachShader(e.program, e.vs);
+        glAttachShader(e.program, e.fs);
+        glLinkProgram(e.program);
+    }
+}
+
+void ShaderBatch::complete(Entry& e) {
+    GLint linked = GL_FALSE;
+    glGetProgramiv(e.program, GL_LINK_STATUS, &linked);
+    if (!linked && !e.fromCache) {
+        char log[512];
+        for (GLuint shader : {e.vs, e.fs}) {
+            GLint compiled = GL_FALSE;
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+            if (!compiled) {
+                glGetShaderInfoLog(shader, 512, nullptr, log);
+                std::cerr << "Shader compile error: " << log << std::endl;
+            }
+        }
+        glGetProgramInfoLog(e.program, 512, nullptr, log);
+        std::cerr << "Program link error: " << log << std::endl;
+    }
+    if (e.vs) glDeleteShader(e.vs);
+    if (e.fs) glDeleteShader(e.fs);
+    e.vs = e.fs = 0;
+    if (!linked) {
+        // Keep drawing with the fallback, if any, rather than an unusable
+        // program.
+        glState().forgetProgram(e.program);
+        glDeleteProgram(e.program);
+        e.program = 0;
+    } else {
+        if (cache && !e.fromCache) cache->store(e.program, e.vsSrc.c_str(), e.fsSrc.c_str());
+        for (const auto& b : blockBindings) ::bindUniformBlock(e.program, b.first.c_str(), b.second);
+    }
+    e.ready = true;
+    ++readyCount;
+}
+
+size_t ShaderBatch::poll() {
+    size_t count = 0;
+    for (Entry& e : entries) {
+        if (e.ready || !e.program) continue;
+        if (parallelCompile && !e.fromCache) {
+            GLint completed = GL_FALSE;
+            glGetProgramiv(e.program, GL_COMPLETION_STATUS_KHR, &completed);
+            if (!completed) continue;
+        }
+        complete(e);
+        ++count;
+    }
+    return count;
+}
+
+void ShaderBatch::finish() {
+    for (Entry& e : entries)
+        if (!e.ready && e.program) complete(e);
+}
+
+GLuint ShaderBatch::program(size_t handle) const {
+    const Entry& e = entries[handle];
+    if (e.ready && e.program) return e.program;
+    return e.fallback != noFallback ? program(e.fallback) : 0;
+}
+
+void ShaderBatch::destroy() {
+    for (Entry& e : entries) {
+        if (e.vs) glDeleteShader(e.vs);
+        if (e.fs) glDeleteShader(e.fs);
+        if (e.program) {
+            glState().forgetProgram(e.program);
+            glDeleteProgram(e.program);
+        }
+    }
+    entries.clear();
+    readyCount = 0;
+}
@@ -0,0 +1,154 @@
+#include "shader_cache.h"
+#include "shader.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+namespace {
+
+const uint32_t cacheMagic = 0x42505346;   // "FSPB"
+const uint32_t cacheVersion = 1;
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;       // guards against hash-named files being swapped
+    uint32_t format;    // GLenum from glGetProgramBinary
+    uint32_t length;
+};
+
+uint64_t fnv1a(uint64_t hash, const char* s) {
+    // The terminator is hashed too so "ab"+"c" and "a"+"bc" differ.
+    for (;; ++s) {
+        hash ^= uint8_t(*s);
+        hash *= 0x100000001b3ull;
+        if (!*s) return hash;
+    }
+}
+
+std::string glString(GLenum name) {
+    const GLubyte* s = glGetString(name);
+    return s ? reinterpret_cast<const char*>(s) : "";
+}
+
+} // namespace
+
+bool ProgramCache::init(const std::string& dir) {
+    directory.clear();
+    if (dir.empty()) return false;
+    if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary) return false;
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) return false;
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        std::cerr << "Cannot create shader cache " << dir << ": " << ec.message() << std::endl;
+        return false;
+    }
+    directory = dir;
+    driver = glString(GL_VENDOR) + "\n" + glString(GL_RENDERER) + "\n" + glString(GL_VERSION);
+    return true;
+}
+
+uint64_t ProgramCache::key(const char* vsSrc, const char* fsSrc) const {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    hash = fnv1a(hash, driver.c_str());
+    hash = fnv1a(hash, vsSrc);
+    return fnv1a(hash, fsSrc);
+}
+
+std::string ProgramCache::pathFor(uint64_t k) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(k));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+GLuint ProgramCache::loadBinary(uint64_t k, const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return 0;
+    CacheHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != cacheMagic ||
+        header.version != cacheVersion || header.key != k) {
+        return 0;
+    }
+    // The entry must be exactly the header plus the binary; anything else
+    // is truncated or corrupt and counts as a miss, before allocating.
+    std::error_code ec;
+    uint64_t fileSize = std::filesystem::file_size(path, ec);
+    if (ec || fileSize < sizeof(header) || header.length != fileSize - sizeof(header) ||
+        header.length > uint64_t(std::numeric_limits<GLsizei>::max()))
+        return 0;
+    std::vector<char> binary(header.length);
+    if (!in.read(binary.data(), std::streamsize(binary.size()))) return 0;
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, GLenum(header.format), binary.data(), GLsizei(binary.size()));
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        glDeleteProgram(program);
+        ++rejected;
+        return 0;
+    }
+    return program;
+}
+
+void ProgramCache::writeBinary(GLuint program, uint64_t k, const std::string& path) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    std::vector<char> binary(size_t(length), 0);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    // Write to a temporary name and rename so a crash never leaves a torn
+    // entry under the real key.
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        CacheHeader header{cacheMagic, cacheVersion, k, uint32_t(format), uint32_t(length)};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(binary.data(), length);
+        if (!out) {
+            std::cerr << "Failed to write shader cache entry " << tmp << std::endl;
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) std::filesystem::remove(tmp, ec);
+}
+
+GLuint ProgramCache::loadCached(const char* vsSrc, const char* fsSrc) {
+    if (!enabled()) return 0;
+    uint64_t k = key(vsSrc, fsSrc);
+    std::string path = pathFor(k);
+    if (GLuint program = loadBinary(k, path)) {
+        ++hits;
+        return program;
+    }
+    ++misses;
+    std::error_code ec;
+    std::filesystem::remove(path, ec);   // stale or rejected entry
+    return 0;
+}
+
+void ProgramCache::store(GLuint program, const char* vsSrc, const char* fsSrc) {
+    if (!enabled()) return;
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    uint64_t k = key(vsSrc, fsSrc);
+    if (linked) writeBinary(program, k, pathFor(k));
+}
+
+GLuint ProgramCache::load(const char* vsSrc, const char* fsSrc) {
+    if (GLuint program = loadCached(vsSrc, fsSrc)) return program;
+    GLuint program = createProgram(vsSrc, fsSrc, enabled());
+    store(program, vsSrc, fsSrc);
+    return program;
+}
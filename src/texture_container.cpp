@@ -0,0 +1,114 @@
+#include "texture_container.h"
+#include "gl_state.h"
+#include "profiler.h"
+#include <cstring>
+#include <iostream>
+
+bool TextureContainer::open(const std::string& path) {
+    if (!file.open(path)) return false;
+    if (open(file.data(), file.size(), path)) return true;
+    file.close();
+    return false;
+}
+
+bool TextureContainer::open(const unsigned char* data, size_t size, const std::string& name) {
+    base = data;
+    auto fail = [&](const char* why) {
+        std::cerr << "Invalid texture container " << name << ": " << why << std::endl;
+        base = nullptr;
+        header = nullptr;
+        entries = nullptr;
+        return false;
+    };
+    if (size < sizeof(CookedTextureHeader)) return fail("truncated header");
+    header = reinterpret_cast<const CookedTextureHeader*>(base);
+    if (header->magic != cookedTextureMagic) return fail("bad magic");
+    if (header->version != cookedTextureVersion) return fail("unsupported version");
+    size_t tableEnd = sizeof(CookedTextureHeader) + size_t(header->textureCount) * sizeof(CookedTextureEntry);
+    if (tableEnd > size) return fail("truncated entry table");
+    entries = reinterpret_cast<const CookedTextureEntry*>(base + sizeof(CookedTextureHeader));
+
+    // Validate once here so upload() can trust every offset.
+    for (uint32_t i = 0; i < header->textureCount; ++i) {
+        const CookedTextureEntry& e = entries[i];
+        if (e.format != CookedRGBA8) return fail("unknown pixel format");
+        if (e.levelCount == 0 || e.levelCount > cookedTextureMaxLevels) return fail("bad level count");
+        if (std::memchr(e.name, 0, cookedTextureNameLength) == nullptr) return fail("unterminated name");
+        if (e.width == 0 || e.height == 0) return fail("empty texture");
+        for (uint32_t l = 0; l < e.levelCount; ++l) {
+            // 64-bit, so a huge corrupt size cannot wrap to a small one.
+            uint64_t w = e.width >> l ? e.width >> l : 1;
+            uint64_t h = e.height >> l ? e.height >> l : 1;
+            if (e.levelSize[l] != w * h * 4) return fail("level size mismatch");
+            if (e.levelOffset[l] > size || e.levelSize[l] > size - e.levelOffset[l])
+                return fail("level data out of range");
+        }
+    }
+    return true;
+}
+
+bool TextureContainer::sameContent(size_t a, size_t b) const {
+    const CookedTextureEntry& ea = entries[a];
+    const CookedTextureEntry& eb = entries[b];
+    if (ea.width != eb.width || ea.height != eb.height || ea.levelCount != eb.levelCount) return false;
+    for (uint32_t l = 0; l < ea.levelCount; ++l)
+        if (std::memcmp(levelData(a, l), levelData(b, l), ea.levelSize[l]) != 0) return false;
+    return true;
+}
+
+std::vector<size_t> TextureContainer::arrayLayers(const std::string& prefix, std::vector<std::string>& names,
+                                                  std::vector<uint32_t>& nameLayers) const {
+    names.clear();
+    nameLayers.clear();
+    std::vector<size_t> layers;
+    for (size_t i = 0; i < count(); ++i) {
+        if (std::strncmp(entries[i].name, prefix.c_str(), prefix.size()) != 0) continue;
+        const CookedTextureEntry& first = entries[layers.empty() ? i : layers[0]];
+        if (entries[i].width != first.width || entries[i].height != first.height ||
+            entries[i].levelCount != first.levelCount) {
+            std::cerr << "Skipping " << entries[i].name << ": size differs from " << first.name << std::endl;
+            continue;
+        }
+        // Identical images share one layer. The bytes are right there in
+        // the mapping, and a comparison stops at the first difference.
+        size_t layer = 0;
+        while (layer < layers.size() && !sameContent(layers[layer], i)) ++layer;
+        if (layer == layers.size()) layers.push_back(i);
+        names.push_back(entries[i].name);
+        nameLayers.push_back(uint32_t(layer));
+    }
+    return layers;
+}
+
+GLuint TextureContainer::uploadArray(const std::vector<size_t>& layers) const {
+    PROFILE_ZONE("UploadCookedTextures");
+    if (layers.empty()) return 0;
+    const CookedTextureEntry& e = entries[layers[0]];
+    GLint maxSize = 0, maxLayers = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    if (e.width > uint32_t(maxSize) || e.height > uint32_t(maxSize) || layers.size() > size_t(maxLayers)) {
+        std::cerr << "Cooked texture array " << e.width << "x" << e.height << "x" << layers.size()
+                  << " exceeds the GL limits (" << maxSize << " texels, " << maxLayers << " layers)" << std::endl;
+        return 0;
+    }
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glState().bindTexture(0, GL_TEXTURE_2D_ARRAY, tex);
+    for (uint32_t l = 0; l < e.levelCount; ++l) {
+        GLsizei w = GLsizei(e.width >> l ? e.width >> l : 1);
+        GLsizei h = GLsizei(e.height >> l ? e.height >> l : 1);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, GLint(l), GL_RGBA, w, h, GLsizei(layers.size()), 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        for (size_t layer = 0; layer < layers.size(); ++layer) {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, GLint(l), 0, 0, GLint(layer), w, h, 1,
+                            GL_RGBA, GL_UNSIGNED_BYTE, levelData(layers[layer], l));
+        }
+    }
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, GLint(e.levelCount - 1));
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    return tex;
+}
@@ -0,0 +1,135 @@
+#include "texture_loader.h"
+#include "gl_state.h"
+#include "pak.h"
+#include "profiler.h"
+#include "stb_image.h"
+#include <cstring>
+#include <iostream>
+
+bool TextureStreamer::start(const std::vector<std::string>& files, JobSystem& jobSystem, const PakArchive* archive) {
+    paths = files;
+    pak = archive;
+    auto readInfo = [&](const std::string& path) {
+        int channels;
+        if (!pak) return stbi_info(path.c_str(), &width, &height, &channels) != 0;
+        const PakEntry* entry = pak->find(path);
+        std::vector<unsigned char> scratch;
+        const unsigned char* data = entry ? pak->bytes(*entry, scratch) : nullptr;
+        return data && stbi_info_from_memory(data, int(entry->size), &width, &height, &channels) != 0;
+    };
+    if (paths.empty() || !readInfo(paths[0])) {
+        std::cerr << "Failed to read texture header" << (paths.empty() ? "" : " of " + paths[0]) << std::endl;
+        return false;
+    }
+
+    std::vector<unsigned char> grey(size_t(width) * height * 4 * paths.size(), 128);
+    glGenTextures(1, &array);
+    glState().bindTexture(0, GL_TEXTURE_2D_ARRAY, array);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, width, height, GLsizei(paths.size()), 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, grey.data());
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glGenBuffers(pboCount, pbos);
+
+    jobs = &jobSystem;
+    for (size_t i = 0; i < paths.size(); ++i)
+        jobs->submitBackground([this, i] { decode(i); }, &decodeJobs);
+    return true;
+}
+
+void TextureStreamer::decode(size_t index) {
+    if (cancel.load()) return;
+    PROFILE_ZONE("DecodeTexture");
+    int w, h, channels;
+    stbi_uc* pixels = nullptr;
+    if (pak) {
+        std::vector<unsigned char> scratch;
+        const PakEntry* entry = pak->find(paths[index]);
+        const unsigned char* data = entry ? pak->bytes(*entry, scratch) : nullptr;
+        if (data) pixels = stbi_load_from_memory(data, int(entry->size), &w, &h, &channels, STBI_rgb_alpha);
+    } else {
+        pixels = stbi_load(paths[index].c_str(), &w, &h, &channels, STBI_rgb_alpha);
+    }
+    if (!pixels) {
+        std::cerr << "Failed to load " << paths[index] << std::endl;
+        ++failed;
+        return;
+    }
+    if (w != width || h != height) {
+        std::cerr << paths[index] << " is " << w << "x" << h << ", texture array layers are "
+                  << width << "x" << height << std::endl;
+        stbi_image_free(pixels);
+        ++failed;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(readyMutex);
+    ready.push_back({index, pixels});
+}
+
+void TextureStreamer::upload(const Decoded& image) {
+    // Copy into a PBO so glTexSubImage3D sources from driver memory and can
+    // return without the driver making its own copy of client memory.
+    GLsizeiptr size = GLsizeiptr(width) * height * 4;
+    GlState& gl = glState();
+    gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+    nextPbo = (nextPbo + 1) % pboCount;
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    const void* src = nullptr;   // offset into the bound PBO
+    if (dst) {
+        std::memcpy(dst, image.pixels, size_t(size));
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    } else {
+        gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        src = image.pixels;
+    }
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, GLint(image.index), width, height, 1,
+                    GL_RGBA, GL_UNSIGNED_BYTE, src);
+    // Client-memory pixel transfers elsewhere expect no unpack buffer.
+    gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+size_t TextureStreamer::pump(size_t maxUploads) {
+    size_t count = 0;
+    // Single-threaded pools have nobody else to decode; do it here, as many
+    // images as may be uploaded this call.
+    if (jobs) jobs->runBackground(maxUploads);
+    {
+        std::lock_guard<std::mutex> lock(readyMutex);
+        if (ready.empty()) return 0;
+    }
+    glState().bindTexture(0, GL_TEXTURE_2D_ARRAY, array);
+    while (count < maxUploads) {
+        Decoded image;
+        {
+            std::lock_guard<std::mutex> lock(readyMutex);
+            if (ready.empty()) break;
+            image = ready.front();
+            ready.pop_front();
+        }
+        upload(image);
+        stbi_image_free(image.pixels);
+        ++uploaded;
+        ++count;
+    }
+    // One mip rebuild covers every layer uploaded this call.
+    if (count) glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    return count;
+}
+
+void TextureStreamer::stop() {
+    cancel = true;
+    // Jobs that have not started return immediately once cancelled.
+    if (jobs) jobs->wait(decodeJobs);
+    jobs = nullptr;
+    for (const Decoded& image : ready) stbi_image_free(image.pixels);
+    ready.clear();
+    if (pbos[0]) {
+        for (GLuint pbo : pbos) glState().forgetBuffer(pbo);
+        glDeleteBuffers(pboCount, pbos);
+        for (GLuint& pbo : pbos) pbo = 0;
+    }
+}
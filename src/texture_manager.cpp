@@ -0,0 +1,197 @@
+#include "texture_manager.h"
+#include "gl_state.h"
+#include "texture_container.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+uint64_t hashTextureContent(const void* data, size_t size, uint64_t seed) {
+    // Eight bytes per step with a multiply-xorshift mix; texel data is large
+    // enough that a byte-at-a-time hash would show up in load times.
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const uint64_t k = 0x9E3779B97F4A7C15ull;
+    uint64_t h = (seed ^ uint64_t(size)) * k;
+    auto mix = [&](uint64_t v) {
+        v *= k;
+        v ^= v >> 29;
+        h = (h ^ v) * 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 32;
+    };
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t v;
+        std::memcpy(&v, p + i, sizeof(v));
+        mix(v);
+    }
+    if (i < size) {
+        uint64_t v = 0;
+        std::memcpy(&v, p + i, size - i);
+        mix(v);
+    }
+    h ^= h >> 31;
+    return h ? h : 1;   // 0 means "not content addressed"
+}
+
+TextureManager::Handle TextureManager::acquire(uint64_t contentHash) {
+    auto it = byContent.find(contentHash);
+    if (contentHash == 0 || it == byContent.end()) return invalid;
+    ++textures[it->second].refs;
+    ++shared;
+    return it->second;
+}
+
+TextureManager::Handle TextureManager::add(const std::string& name, GLuint texture, GLenum target,
+                                           uint64_t contentHash, uint32_t width, uint32_t height,
+                                           uint32_t layers, uint32_t levelCount) {
+    Handle handle;
+    if (!freeSlots.empty()) {
+        handle = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        handle = Handle(textures.size());
+        textures.emplace_back();
+    }
+    Entry& e = textures[handle];
+    e = Entry{};
+    e.name = name;
+    e.texture = texture;
+    e.target = target;
+    e.contentHash = contentHash;
+    e.width = width;
+    e.height = height;
+    e.layers = layers;
+    e.levelCount = levelCount;
+    e.refs = 1;
+    e.lastUsed = frame;
+    for (uint32_t l = 0; l < levelCount; ++l) e.bytes += levelBytes(e, l);
+    resident += e.bytes;
+    ++live;
+    nextCheck = 0;
+    if (contentHash) byContent.emplace(contentHash, handle);
+    return handle;
+}
+
+void TextureManager::addRef(Handle handle) {
+    ++textures[handle].refs;
+}
+
+void TextureManager::release(Handle handle) {
+    Entry& e = textures[handle];
+    if (handle == invalid || e.refs == 0 || --e.refs > 0) return;
+    glState().forgetTexture(e.texture);
+    glDeleteTextures(1, &e.texture);
+    if (e.contentHash) byContent.erase(e.contentHash);
+    resident -= e.bytes;
+    --live;
+    e = Entry{};
+    freeSlots.push_back(handle);
+}
+
+void TextureManager::releaseAll() {
+    for (Handle h = 1; h < textures.size(); ++h) {
+        if (textures[h].refs == 0) continue;
+        textures[h].refs = 1;
+        release(h);
+    }
+}
+
+size_t TextureManager::levelBytes(const Entry& e, uint32_t level) {
+    size_t w = e.width >> level ? e.width >> level : 1;
+    size_t h = e.height >> level ? e.height >> level : 1;
+    return w * h * 4 * e.layers;
+}
+
+bool TextureManager::evictLevel(Entry& e) {
+    if (e.baseLevel + 1 >= e.levelCount) return false;
+    if (std::max(e.width >> e.baseLevel, e.height >> e.baseLevel) <= minEvictedSize) return false;
+    // Raise the base level first so the texture stays complete, then give
+    // the old level zero size, which releases its storage.
+    glState().bindTexture(0, e.target, e.texture);
+    glTexParameteri(e.target, GL_TEXTURE_BASE_LEVEL, GLint(e.baseLevel + 1));
+    if (e.target == GL_TEXTURE_2D_ARRAY)
+        glTexImage3D(e.target, GLint(e.baseLevel), GL_RGBA, 0, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    else
+        glTexImage2D(e.target, GLint(e.baseLevel), GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    const size_t freed = levelBytes(e, e.baseLevel);
+    ++e.baseLevel;
+    e.bytes -= freed;
+    resident -= freed;
+    ++evictedLevels;
+    return true;
+}
+
+size_t TextureManager::enforceBudget() {
+    if (budget == 0 || resident <= budget || frame < nextCheck) return 0;
+    const size_t before = resident;
+    // Idle candidates oldest first; among equals the biggest goes first.
+    // The earliest a texture in use could become idle bounds when looking
+    // again can help.
+    std::vector<Handle> order;
+    uint64_t nextIdle = UINT64_MAX;
+    for (Handle h = 1; h < textures.size(); ++h) {
+        const Entry& e = textures[h];
+        if (!e.refs) continue;
+        if (frame - e.lastUsed >= idleFrames) order.push_back(h);
+        else nextIdle = std::min(nextIdle, e.lastUsed + idleFrames);
+    }
+    std::sort(order.begin(), order.end(), [&](Handle a, Handle b) {
+        const Entry& ea = textures[a];
+        const Entry& eb = textures[b];
+        return ea.lastUsed != eb.lastUsed ? ea.lastUsed < eb.lastUsed : ea.bytes > eb.bytes;
+    });
+    for (Handle h : order) {
+        while (resident > budget && evictLevel(textures[h])) {}
+        if (resident <= budget) break;
+    }
+    // Idle textures are now as small as they go; only newly idle ones can
+    // free more.
+    if (resident > budget) nextCheck = nextIdle;
+    return before - resident;
+}
+
+void TextureManager::printReport(std::ostream& out) const {
+    out << "Textures: " << live << " live, " << std::fixed << std::setprecision(2)
+        << double(resident) / (1024.0 * 1024.0) << " MiB resident";
+    if (budget) out << " of " << double(budget) / (1024.0 * 1024.0) << " MiB budget";
+    out << ", " << shared << " shared loads, " << evictedLevels << " mip levels evicted" << std::endl;
+    out.unsetf(std::ios::floatfield);
+    for (Handle h = 1; h < textures.size(); ++h) {
+        const Entry& e = textures[h];
+        if (!e.refs) continue;
+        out << "  " << e.name << ": " << (e.width >> e.baseLevel ? e.width >> e.baseLevel : 1) << "x"
+            << (e.height >> e.baseLevel ? e.height >> e.baseLevel : 1);
+        if (e.layers > 1) out << "x" << e.layers;
+        out << ", " << e.levelCount - e.baseLevel << " levels, " << e.bytes / 1024 << " KiB, " << e.refs
+            << (e.refs == 1 ? " reference" : " references") << std::endl;
+    }
+}
+
+uint64_t cookedContentHash(const TextureContainer& container, size_t i) {
+    const CookedTextureEntry& e = container.entry(i);
+    const uint32_t size[2] = {e.width, e.height};
+    uint64_t hash = hashTextureContent(size, sizeof(size));
+    for (uint32_t l = 0; l < e.levelCount; ++l)
+        hash = hashTextureContent(container.levelData(i, l), e.levelSize[l], hash);
+    return hash;
+}
+
+TextureManager::Handle uploadCookedArray(TextureManager& textures, const TextureContainer& container,
+                                         const std::string& prefix, std::vector<std::string>& names,
+                                         std::vector<uint32_t>& nameLayers) {
+    std::vector<size_t> layers = container.arrayLayers(prefix, names, nameLayers);
+    if (layers.empty()) return TextureManager::invalid;
+    if (names.size() > layers.size())
+        std::cout << "Shared " << names.size() - layers.size() << " duplicate textures" << std::endl;
+    uint64_t hash = 0;
+    for (size_t i : layers) {
+        const uint64_t layerHash = cookedContentHash(container, i);
+        hash = hashTextureContent(&layerHash, sizeof(layerHash), hash);
+    }
+    if (TextureManager::Handle existing = textures.acquire(hash)) return existing;
+    const GLuint array = container.uploadArray(layers);
+    if (!array) return TextureManager::invalid;
+    const CookedTextureEntry& e = container.entry(layers[0]);
+    return textures.add(prefix + "*", array, GL_TEXTURE_2D_ARRAY, hash, e.width, e.height, uint32_t(layers.size()),
+                        e.levelCount);
+}
@@ -0,0 +1,98 @@
+#include "uniform_ring.h"
+#include "gl_state.h"
+#include "timer.h"
+#include <SDL.h>
+#include <cstring>
+#include <iostream>
+
+static size_t roundUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool UniformRing::init(size_t bytesPerFrame) {
+    GLint align = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+    alignment = align > 0 ? size_t(align) : 256;
+    regionSize = roundUp(bytesPerFrame ? bytesPerFrame : 1, alignment);
+    GLsizeiptr total = GLsizeiptr(regionSize * frameCount);
+
+    glGenBuffers(1, &buffer);
+    glState().bindBuffer(GL_UNIFORM_BUFFER, buffer);
+    if (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_UNIFORM_BUFFER, total, nullptr, flags);
+        mapped = static_cast<unsigned char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, total, flags));
+        if (!mapped) {
+            // Immutable storage cannot be respecified; start over with a new buffer.
+            std::cerr << "Persistent uniform mapping failed, using glBufferSubData" << std::endl;
+            glState().forgetBuffer(buffer);
+            glDeleteBuffers(1, &buffer);
+            glGenBuffers(1, &buffer);
+            glState().bindBuffer(GL_UNIFORM_BUFFER, buffer);
+        }
+    }
+    if (!mapped) {
+        glBufferData(GL_UNIFORM_BUFFER, total, nullptr, GL_STREAM_DRAW);
+        staging.resize(regionSize);
+    }
+    current = frameCount - 1;
+    return true;
+}
+
+void UniformRing::shutdown() {
+    for (GLsync& fence : fences) {
+        if (fence) glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (buffer) {
+        if (mapped) {
+            glState().bindBuffer(GL_UNIFORM_BUFFER, buffer);
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+            mapped = nullptr;
+        }
+        glState().forgetBuffer(buffer);
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+}
+
+void UniformRing::beginFrame() {
+    current = (current + 1) % frameCount;
+    head = uploaded = 0;
+    lastWaitMs = 0.0;
+    GLsync& fence = fences[current];
+    if (!fence) return;
+    // Normally long signalled: the GPU finished this region frameCount-1
+    // frames ago. Flush so the wait cannot deadlock on unsubmitted work.
+    Uint64 start = SDL_GetPerformanceCounter();
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    while (result == GL_TIMEOUT_EXPIRED)
+        result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+    if (result == GL_WAIT_FAILED) std::cerr << "Uniform ring fence wait failed" << std::endl;
+    lastWaitMs = elapsedMs(start, SDL_GetPerformanceCounter());
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+GLintptr UniformRing::allocate(const void* data, size_t size) {
+    size_t offset = roundUp(head, alignment);
+    if (offset + size > regionSize) {
+        ++overflows;
+        return -1;
+    }
+    std::memcpy(mapped ? mapped + size_t(current) * regionSize + offset : staging.data() + offset, data, size);
+    head = offset + size;
+    return GLintptr(size_t(current) * regionSize + offset);
+}
+
+void UniformRing::upload() {
+    if (mapped || head == uploaded) return;
+    glState().bindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, GLintptr(size_t(current) * regionSize + uploaded),
+                    GLsizeiptr(head - uploaded), staging.data() + uploaded);
+    uploaded = head;
+}
+
+void UniformRing::endFrame() {
+    fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
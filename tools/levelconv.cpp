@@ -0,0 +1,278 @@
+// Offline level converter: builds the geometry a text level description asks
+// for (loading any models it references), runs every mesh through
+// optimizeMesh() and writes the mapped level format, see
+// include/level_format.h. Model paths are relative to the description.
+//
+//   levelconv <output.lvl> <level.txt>
+//
+// Description statements, one per line, # starts a comment:
+//   material <name> <texture> <r> <g> <b>
+//   room <x0> <y0> <z0> <x1> <y1> <z1> <wall thickness> <material> [5 more]
+//       inward-facing box with slab colliders, as one mesh; one material
+//       for every face or one each for the -z, +z, -x and +x walls, ceiling
+//       and floor
+//   model <name> <file.obj|file.glb> <material> <x> <y> <z> <yaw> <size>
+//       scaled so its largest side is size, standing on x y z, with a box
+//       collider around it
+//   collider <cx> <cy> <cz> <hx> <hy> <hz>
+//   player_start <x> <y> <z> <yaw>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "level_format.h"
+#include "mesh_optimizer.h"
+#include "model_loader.h"
+
+struct SourceMaterial {
+    std::string name;
+    uint32_t index;
+    glm::vec3 tint;
+};
+
+struct LevelBuilder {
+    std::map<std::string, SourceMaterial> materialNames;
+    std::vector<LevelMaterial> materials;
+    std::vector<LevelMesh> meshes;
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<LevelEntity> entities;
+    std::vector<LevelCollider> colliders;
+
+    // Optimises the mesh, appends it and places it with a static entity.
+    bool addMesh(const std::string& name, uint32_t material, std::vector<Vertex> meshVertices,
+                 std::vector<uint32_t> meshIndices, glm::vec3 position, float yaw, float scale) {
+        if (name.size() >= levelNameLength) {
+            std::cerr << "Mesh name too long: " << name << std::endl;
+            return false;
+        }
+        printMeshReport(std::cout, name.c_str(), optimizeMesh(meshVertices, meshIndices));
+        LevelMesh mesh{};
+        std::memcpy(mesh.name, name.c_str(), name.size());
+        mesh.firstVertex = uint32_t(vertices.size());
+        mesh.vertexCount = uint32_t(meshVertices.size());
+        mesh.firstIndex = uint32_t(indices.size());
+        mesh.indexCount = uint32_t(meshIndices.size());
+        mesh.material = material;
+        vertices.insert(vertices.end(), meshVertices.begin(), meshVertices.end());
+        indices.insert(indices.end(), meshIndices.begin(), meshIndices.end());
+        entities.push_back({LevelStaticMesh, uint32_t(meshes.size()), {position.x, position.y, position.z}, yaw,
+                            scale, 0});
+        meshes.push_back(mesh);
+        return true;
+    }
+
+    void addCollider(glm::vec3 center, glm::vec3 half) {
+        colliders.push_back({{center.x, center.y, center.z}, {half.x, half.y, half.z}});
+    }
+};
+
+static bool parseRoom(LevelBuilder& level, const std::vector<SourceMaterial>& faceMaterials,
+                      glm::vec3 lo, glm::vec3 hi, float t) {
+    // Per face: corners counter-clockwise from the bottom left, and the
+    // normal facing into the room. Order: -z, +z, -x, +x walls, ceiling, floor.
+    const glm::vec3 corners[6][4] = {
+        {{lo.x, lo.y, lo.z}, {hi.x, lo.y, lo.z}, {hi.x, hi.y, lo.z}, {lo.x, hi.y, lo.z}},
+        {{lo.x, lo.y, hi.z}, {hi.x, lo.y, hi.z}, {hi.x, hi.y, hi.z}, {lo.x, hi.y, hi.z}},
+        {{lo.x, lo.y, lo.z}, {lo.x, lo.y, hi.z}, {lo.x, hi.y, hi.z}, {lo.x, hi.y, lo.z}},
+        {{hi.x, lo.y, lo.z}, {hi.x, lo.y, hi.z}, {hi.x, hi.y, hi.z}, {hi.x, hi.y, lo.z}},
+        {{lo.x, hi.y, lo.z}, {hi.x, hi.y, lo.z}, {hi.x, hi.y, hi.z}, {lo.x, hi.y, hi.z}},
+        {{lo.x, lo.y, lo.z}, {hi.x, lo.y, lo.z}, {hi.x, lo.y, hi.z}, {lo.x, lo.y, hi.z}},
+    };
+    const glm::vec3 normals[6] = {{0.f, 0.f, 1.f}, {0.f, 0.f, -1.f}, {1.f, 0.f, 0.f},
+                                  {-1.f, 0.f, 0.f}, {0.f, -1.f, 0.f}, {0.f, 1.f, 0.f}};
+    const glm::vec2 uvs[4] = {{0.f, 0.f}, {1.f, 0.f}, {1.f, 1.f}, {0.f, 1.f}};
+
+    // One mesh for the whole room: each face's vertices name its material,
+    // so the room is one draw however many materials it uses.
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    for (int f = 0; f < 6; ++f) {
+        const SourceMaterial& material = faceMaterials[size_t(f)];
+        const uint32_t base = uint32_t(vertices.size());
+        for (int v = 0; v < 4; ++v)
+            vertices.push_back({corners[f][v], material.tint, uvs[v], levelVertexLayer(material.index), normals[f]});
+        for (uint32_t i : {0u, 1u, 2u, 2u, 3u, 0u}) indices.push_back(base + i);
+    }
+    if (!level.addMesh("room", faceMaterials[0].index, std::move(vertices), std::move(indices), glm::vec3(0.0f), 0.0f,
+                       1.0f))
+        return false;
+
+    // Slabs of thickness t just outside every face.
+    glm::vec3 center = (lo + hi) * 0.5f, half = (hi - lo) * 0.5f;
+    level.addCollider({center.x, lo.y - t, center.z}, {half.x + t, t, half.z + t});
+    level.addCollider({center.x, hi.y + t, center.z}, {half.x + t, t, half.z + t});
+    level.addCollider({lo.x - t, center.y, center.z}, {t, half.y, half.z});
+    level.addCollider({hi.x + t, center.y, center.z}, {t, half.y, half.z});
+    level.addCollider({center.x, center.y, lo.z - t}, {half.x, half.y, t});
+    level.addCollider({center.x, center.y, hi.z + t}, {half.x, half.y, t});
+    return true;
+}
+
+static bool parseModel(LevelBuilder& level, const std::string& name, const std::filesystem::path& file,
+                       const SourceMaterial& material, glm::vec3 position, float yaw, float size) {
+    ModelData model;
+    if (!loadModel(file.string(), model)) return false;
+    fitModel(model, size);
+    for (Vertex& v : model.vertices) {
+        v.color = v.color * material.tint;
+        v.layer = levelVertexLayer(material.index);
+    }
+
+    // Collide with the box around the model's bounds turned by yaw.
+    glm::vec3 lo = model.vertices[0].position, hi = lo;
+    for (const Vertex& v : model.vertices) {
+        lo = glm::min(lo, v.position);
+        hi = glm::max(hi, v.position);
+    }
+    glm::vec3 center = (lo + hi) * 0.5f, half = (hi - lo) * 0.5f;
+    float c = std::cos(glm::radians(yaw)), s = std::sin(glm::radians(yaw));
+    glm::vec3 turned{c * center.x + s * center.z, center.y, -s * center.x + c * center.z};
+    c = std::fabs(c);
+    s = std::fabs(s);
+    level.addCollider(position + turned, {c * half.x + s * half.z, half.y, s * half.x + c * half.z});
+
+    return level.addMesh(name, material.index, std::move(model.vertices), std::move(model.indices), position, yaw,
+                         1.0f);
+}
+
+static bool parseDescription(const std::filesystem::path& path, LevelBuilder& level) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Failed to open " << path.string() << std::endl;
+        return false;
+    }
+    std::string line;
+    int lineNumber = 0;
+    auto fail = [&](const std::string& why) {
+        std::cerr << path.string() << ":" << lineNumber << ": " << why << std::endl;
+        return false;
+    };
+    auto findMaterial = [&](const std::string& name, SourceMaterial& out) {
+        auto it = level.materialNames.find(name);
+        if (it == level.materialNames.end()) return false;
+        out = it->second;
+        return true;
+    };
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        std::string keyword;
+        if (!(words >> keyword)) continue;
+
+        if (keyword == "material") {
+            std::string name, texture;
+            glm::vec3 tint;
+            if (!(words >> name >> texture >> tint.x >> tint.y >> tint.z)) return fail("expected name, texture and tint");
+            if (texture.size() >= levelTextureNameLength) return fail("texture name too long");
+            if (level.materialNames.count(name)) return fail("material " + name + " defined twice");
+            if (level.materials.size() == levelMaxMaterials) return fail("too many materials");
+            LevelMaterial material{};
+            std::memcpy(material.texture, texture.c_str(), texture.size());
+            level.materialNames[name] = {name, uint32_t(level.materials.size()), tint};
+            level.materials.push_back(material);
+        } else if (keyword == "room") {
+            glm::vec3 lo, hi;
+            float thickness;
+            if (!(words >> lo.x >> lo.y >> lo.z >> hi.x >> hi.y >> hi.z >> thickness))
+                return fail("expected two corners and a wall thickness");
+            std::vector<SourceMaterial> faceMaterials;
+            std::string name;
+            while (words >> name) {
+                SourceMaterial material;
+                if (!findMaterial(name, material)) return fail("unknown material " + name);
+                faceMaterials.push_back(material);
+            }
+            if (faceMaterials.size() == 1) faceMaterials.resize(6, faceMaterials[0]);
+            if (faceMaterials.size() != 6) return fail("expected one or six materials");
+            if (!parseRoom(level, faceMaterials, glm::min(lo, hi), glm::max(lo, hi), thickness)) return false;
+        } else if (keyword == "model") {
+            std::string name, file, materialName;
+            glm::vec3 position;
+            float yaw, size;
+            if (!(words >> name >> file >> materialName >> position.x >> position.y >> position.z >> yaw >> size))
+                return fail("expected name, file, material, position, yaw and size");
+            SourceMaterial material;
+            if (!findMaterial(materialName, material)) return fail("unknown material " + materialName);
+            if (!parseModel(level, name, path.parent_path() / file, material, position, yaw, size)) return false;
+        } else if (keyword == "collider") {
+            glm::vec3 center, half;
+            if (!(words >> center.x >> center.y >> center.z >> half.x >> half.y >> half.z))
+                return fail("expected centre and half extents");
+            level.addCollider(center, half);
+        } else if (keyword == "player_start") {
+            glm::vec3 p;
+            float yaw;
+            if (!(words >> p.x >> p.y >> p.z >> yaw)) return fail("expected position and yaw");
+            level.entities.push_back({LevelPlayerStart, 0, {p.x, p.y, p.z}, yaw, 1.0f, 0});
+        } else {
+            return fail("unknown statement " + keyword);
+        }
+    }
+    if (level.meshes.empty()) return fail("level has no geometry");
+    return true;
+}
+
+static uint64_t alignUp(uint64_t v, uint64_t a) { return (v + a - 1) / a * a; }
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <output.lvl> <level.txt>" << std::endl;
+        return 1;
+    }
+    LevelBuilder level;
+    if (!parseDescription(argv[2], level)) return 1;
+
+    // Sections in header order, each starting on an aligned offset.
+    struct Blob {
+        LevelSection* section;
+        const void* data;
+        size_t count;
+        size_t elementSize;
+    };
+    LevelHeader header{};
+    header.magic = levelMagic;
+    header.version = levelVersion;
+    const Blob blobs[] = {
+        {&header.materials, level.materials.data(), level.materials.size(), sizeof(LevelMaterial)},
+        {&header.meshes, level.meshes.data(), level.meshes.size(), sizeof(LevelMesh)},
+        {&header.vertices, level.vertices.data(), level.vertices.size(), sizeof(Vertex)},
+        {&header.indices, level.indices.data(), level.indices.size(), sizeof(uint32_t)},
+        {&header.entities, level.entities.data(), level.entities.size(), sizeof(LevelEntity)},
+        {&header.colliders, level.colliders.data(), level.colliders.size(), sizeof(LevelCollider)},
+    };
+    uint64_t offset = sizeof(header);
+    for (const Blob& blob : blobs) {
+        offset = alignUp(offset, levelDataAlignment);
+        *blob.section = {offset, blob.count};
+        offset += blob.count * blob.elementSize;
+    }
+
+    std::ofstream out(argv[1], std::ios::binary);
+    if (!out) {
+        std::cerr << "Failed to open " << argv[1] << std::endl;
+        return 1;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const Blob& blob : blobs) {
+        // Pad with zeros up to the aligned offset recorded in the header.
+        std::vector<char> pad(size_t(blob.section->offset - uint64_t(out.tellp())), 0);
+        out.write(pad.data(), std::streamsize(pad.size()));
+        out.write(static_cast<const char*>(blob.data), std::streamsize(blob.count * blob.elementSize));
+    }
+    if (!out) {
+        std::cerr << "Failed to write " << argv[1] << std::endl;
+        return 1;
+    }
+    std::cout << "Converted " << argv[2] << ": " << level.meshes.size() << " meshes, " << level.vertices.size()
+              << " vertices, " << level.entities.size() << " entities, " << level.colliders.size() << " colliders"
+              << std::endl;
+    return 0;
+}
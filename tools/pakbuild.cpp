@@ -0,0 +1,155 @@
+// Offline packer: gathers loose asset files into one pak archive with a
+// hashed table of contents, see include/pak_format.h.
+//
+//   pakbuild <output.pak> [--store] [--prefix DIR/] <name=path | path>...
+//
+// A bare path is named by its file name, after the most recent --prefix.
+// Entries are compressed unless --store is given or compression saves less
+// than an eighth of the entry.
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "block_compress.h"
+#include "pak_format.h"
+
+struct PackedFile {
+    std::string name;
+    std::string path;
+    std::vector<unsigned char> stored;
+    uint64_t size = 0;
+    uint32_t compression = PakStored;
+};
+
+static bool readFile(const std::string& path, std::vector<unsigned char>& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+static uint64_t alignUp(uint64_t v, uint64_t a) { return (v + a - 1) / a * a; }
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <output.pak> [--store] [--prefix DIR/] <name=path | path>..."
+                  << std::endl;
+        return 1;
+    }
+    bool store = false;
+    std::string prefix;
+    std::vector<PackedFile> files;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--store") {
+            store = true;
+        } else if (arg == "--prefix" && i + 1 < argc) {
+            prefix = argv[++i];
+        } else {
+            PackedFile file;
+            size_t eq = arg.find('=');
+            if (eq != std::string::npos) {
+                file.name = arg.substr(0, eq);
+                file.path = arg.substr(eq + 1);
+            } else {
+                file.name = prefix + std::filesystem::path(arg).filename().generic_string();
+                file.path = arg;
+            }
+            files.push_back(std::move(file));
+        }
+    }
+    std::sort(files.begin(), files.end(), [](const PackedFile& a, const PackedFile& b) { return a.name < b.name; });
+    for (size_t i = 1; i < files.size(); ++i) {
+        if (files[i].name == files[i - 1].name) {
+            std::cerr << "Duplicate entry " << files[i].name << std::endl;
+            return 1;
+        }
+    }
+
+    uint64_t totalSize = 0, totalStored = 0;
+    std::vector<unsigned char> raw, packed;
+    for (PackedFile& file : files) {
+        if (!readFile(file.path, raw)) {
+            std::cerr << "Failed to read " << file.path << std::endl;
+            return 1;
+        }
+        file.size = raw.size();
+        if (!store && !raw.empty()) {
+            blockCompress(raw.data(), raw.size(), packed);
+            if (packed.size() <= raw.size() - raw.size() / 8) {
+                file.stored.swap(packed);
+                file.compression = PakBlock;
+            }
+        }
+        if (file.compression == PakStored) file.stored.swap(raw);
+        totalSize += file.size;
+        totalStored += file.stored.size();
+    }
+
+    // Header, entries, buckets and names up front; data after, each entry
+    // starting on an aligned offset.
+    PakHeader header{};
+    header.magic = pakMagic;
+    header.version = pakVersion;
+    header.entryCount = uint32_t(files.size());
+    header.bucketCount = 1;
+    while (header.bucketCount < 2 * header.entryCount + 1) header.bucketCount *= 2;
+    header.entriesOffset = sizeof(PakHeader);
+    header.bucketsOffset = header.entriesOffset + uint64_t(header.entryCount) * sizeof(PakEntry);
+    header.namesOffset = header.bucketsOffset + uint64_t(header.bucketCount) * sizeof(uint32_t);
+
+    std::vector<PakEntry> entries(files.size());
+    std::string names;
+    for (size_t i = 0; i < files.size(); ++i) {
+        entries[i].nameHash = pakHash(files[i].name);
+        entries[i].nameOffset = uint32_t(names.size());
+        entries[i].nameLength = uint32_t(files[i].name.size());
+        names += files[i].name;
+    }
+    header.namesSize = names.size();
+    uint64_t offset = header.namesOffset + header.namesSize;
+    for (size_t i = 0; i < files.size(); ++i) {
+        offset = alignUp(offset, pakDataAlignment);
+        entries[i].offset = offset;
+        entries[i].storedSize = files[i].stored.size();
+        entries[i].size = files[i].size;
+        entries[i].compression = files[i].compression;
+        offset += files[i].stored.size();
+    }
+
+    std::vector<uint32_t> buckets(header.bucketCount, pakEmptyBucket);
+    const uint32_t mask = header.bucketCount - 1;
+    for (uint32_t i = 0; i < header.entryCount; ++i) {
+        uint32_t b = uint32_t(entries[i].nameHash) & mask;
+        while (buckets[b] != pakEmptyBucket) b = (b + 1) & mask;
+        buckets[b] = i;
+    }
+
+    std::ofstream out(argv[1], std::ios::binary);
+    if (!out) {
+        std::cerr << "Failed to open " << argv[1] << std::endl;
+        return 1;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), std::streamsize(entries.size() * sizeof(PakEntry)));
+    out.write(reinterpret_cast<const char*>(buckets.data()), std::streamsize(buckets.size() * sizeof(uint32_t)));
+    out.write(names.data(), std::streamsize(names.size()));
+    for (size_t i = 0; i < files.size(); ++i) {
+        // Pad with zeros up to the aligned offset recorded in the entry.
+        std::vector<char> pad(size_t(entries[i].offset - uint64_t(out.tellp())), 0);
+        out.write(pad.data(), std::streamsize(pad.size()));
+        out.write(reinterpret_cast<const char*>(files[i].stored.data()), std::streamsize(files[i].stored.size()));
+    }
+    if (!out) {
+        std::cerr << "Failed to write " << argv[1] << std::endl;
+        return 1;
+    }
+    std::cout << "Packed " << files.size() << " files into " << argv[1] << ": " << totalSize << " -> "
+              << totalStored << " bytes" << std::endl;
+    return 0;
+}
@@ -0,0 +1,125 @@
+// Offline texture cooker: decodes PNGs once at build time and writes a
+// container holding the full RGBA8 mip chain of every image, see
+// include/texture_format.h.
+//
+//   texcook <output.ftc> <image.png>...
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "texture_format.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+struct CookedImage {
+    std::string name;
+    uint32_t width = 0, height = 0;
+    std::vector<std::vector<unsigned char>> levels;
+};
+
+// 2x2 box filter, matching what glGenerateMipmap does for RGBA8. Odd
+// dimensions clamp the last row/column instead of wrapping.
+static std::vector<unsigned char> downsample(const std::vector<unsigned char>& src, uint32_t w, uint32_t h) {
+    uint32_t dw = w > 1 ? w / 2 : 1, dh = h > 1 ? h / 2 : 1;
+    std::vector<unsigned char> dst(size_t(dw) * dh * 4);
+    for (uint32_t y = 0; y < dh; ++y) {
+        uint32_t y0 = std::min(2 * y, h - 1), y1 = std::min(2 * y + 1, h - 1);
+        for (uint32_t x = 0; x < dw; ++x) {
+            uint32_t x0 = std::min(2 * x, w - 1), x1 = std::min(2 * x + 1, w - 1);
+            for (int c = 0; c < 4; ++c) {
+                unsigned sum = src[(size_t(y0) * w + x0) * 4 + c] + src[(size_t(y0) * w + x1) * 4 + c] +
+                               src[(size_t(y1) * w + x0) * 4 + c] + src[(size_t(y1) * w + x1) * 4 + c];
+                dst[(size_t(y) * dw + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+    return dst;
+}
+
+static bool cookImage(const std::string& path, CookedImage& out) {
+    int w, h, channels;
+    stbi_uc* pixels = stbi_load(path.c_str(), &w, &h, &channels, STBI_rgb_alpha);
+    if (!pixels) {
+        std::cerr << "Failed to load " << path << ": " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+    out.name = std::filesystem::path(path).stem().string();
+    if (out.name.size() >= cookedTextureNameLength) {
+        std::cerr << "Texture name too long: " << out.name << std::endl;
+        stbi_image_free(pixels);
+        return false;
+    }
+    out.width = uint32_t(w);
+    out.height = uint32_t(h);
+    out.levels.emplace_back(pixels, pixels + size_t(w) * h * 4);
+    stbi_image_free(pixels);
+
+    uint32_t lw = out.width, lh = out.height;
+    while ((lw > 1 || lh > 1) && out.levels.size() < cookedTextureMaxLevels) {
+        out.levels.push_back(downsample(out.levels.back(), lw, lh));
+        lw = lw > 1 ? lw / 2 : 1;
+        lh = lh > 1 ? lh / 2 : 1;
+    }
+    return true;
+}
+
+static uint64_t alignUp(uint64_t v, uint64_t a) { return (v + a - 1) / a * a; }
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <output.ftc> <image.png>..." << std::endl;
+        return 1;
+    }
+
+    std::vector<CookedImage> images;
+    for (int i = 2; i < argc; ++i) {
+        CookedImage image;
+        if (!cookImage(argv[i], image)) return 1;
+        images.push_back(std::move(image));
+    }
+
+    CookedTextureHeader header{cookedTextureMagic, cookedTextureVersion, uint32_t(images.size()), 0};
+    std::vector<CookedTextureEntry> entries(images.size());
+    uint64_t offset = alignUp(sizeof(header) + entries.size() * sizeof(CookedTextureEntry), cookedTextureDataAlignment);
+    for (size_t i = 0; i < images.size(); ++i) {
+        CookedTextureEntry& e = entries[i];
+        std::memset(&e, 0, sizeof(e));
+        std::memcpy(e.name, images[i].name.c_str(), images[i].name.size());
+        e.width = images[i].width;
+        e.height = images[i].height;
+        e.levelCount = uint32_t(images[i].levels.size());
+        e.format = CookedRGBA8;
+        for (uint32_t l = 0; l < e.levelCount; ++l) {
+            e.levelOffset[l] = offset;
+            e.levelSize[l] = uint32_t(images[i].levels[l].size());
+            offset = alignUp(offset + e.levelSize[l], cookedTextureDataAlignment);
+        }
+    }
+
+    std::ofstream out(argv[1], std::ios::binary);
+    if (!out) {
+        std::cerr << "Failed to open " << argv[1] << std::endl;
+        return 1;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), std::streamsize(entries.size() * sizeof(CookedTextureEntry)));
+    for (size_t i = 0; i < images.size(); ++i) {
+        for (uint32_t l = 0; l < entries[i].levelCount; ++l) {
+            // Pad with zeros up to the aligned offset recorded in the table.
+            std::vector<char> pad(size_t(entries[i].levelOffset[l] - uint64_t(out.tellp())), 0);
+            out.write(pad.data(), std::streamsize(pad.size()));
+            out.write(reinterpret_cast<const char*>(images[i].levels[l].data()), std::streamsize(images[i].levels[l].size()));
+        }
+    }
+    if (!out) {
+        std::cerr << "Failed to write " << argv[1] << std::endl;
+        return 1;
+    }
+    std::cout << "Cooked " << images.size() << " textures into " << argv[1] << std::endl;
+    return 0;
+}